@@ -0,0 +1,316 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "aabb_batch.h"
+#include "rect.h"
+#include <algorithm>
+
+//x86 builds get SSE2 always and AVX2 when the cpu reports it
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define AABB_HAVE_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define AABB_HAVE_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+namespace common {
+
+  /**
+   * Count the set bits in a word
+   * @param  v the word
+   * @return   the number of set bits
+   */
+  static size_t popcount(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(v);
+#else
+    size_t n = 0;
+    for (; v; v &= v - 1) {
+      n++;
+    }
+    return n;
+#endif
+  }
+
+  /**
+   * Test rects one at a time
+   * @param query the rect to test
+   * @param rects the rects
+   * @param start the first rect to test
+   * @param count the number of rects
+   * @param mask  the hit words (zeroed)
+   */
+  static void overlap_scalar(const SDL_Rect& query,
+                             const SDL_Rect* rects,
+                             size_t start,
+                             size_t count,
+                             uint64_t* mask) {
+    for (size_t i=start; i<count; i++) {
+      if (rect_overlaps(rects[i], query)) {
+        mask[i / 64] |= (uint64_t)1 << (i % 64);
+      }
+    }
+  }
+
+#ifdef AABB_HAVE_SSE2
+  /**
+   * Test rects four at a time
+   * @param  query the rect to test
+   * @param  rects the rects
+   * @param  count the number of rects
+   * @param  mask  the hit words (zeroed)
+   * @return       the number of rects tested
+   */
+  static size_t overlap_sse2(const SDL_Rect& query,
+                             const SDL_Rect* rects,
+                             size_t count,
+                             uint64_t* mask) {
+    const __m128i qx0 = _mm_set1_epi32(query.x);
+    const __m128i qy0 = _mm_set1_epi32(query.y);
+    const __m128i qx1 = _mm_set1_epi32(query.x + query.w);
+    const __m128i qy1 = _mm_set1_epi32(query.y + query.h);
+
+    size_t i = 0;
+    for (; (i + 4) <= count; i += 4) {
+      //each register holds one rect (x,y,w,h), transpose to x,y,w,h registers
+      __m128i r0 = _mm_loadu_si128((const __m128i*)&rects[i]);
+      __m128i r1 = _mm_loadu_si128((const __m128i*)&rects[i + 1]);
+      __m128i r2 = _mm_loadu_si128((const __m128i*)&rects[i + 2]);
+      __m128i r3 = _mm_loadu_si128((const __m128i*)&rects[i + 3]);
+
+      __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+      __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+      __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+      __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+      __m128i x = _mm_unpacklo_epi64(t0, t1);
+      __m128i y = _mm_unpackhi_epi64(t0, t1);
+      __m128i w = _mm_unpacklo_epi64(t2, t3);
+      __m128i h = _mm_unpackhi_epi64(t2, t3);
+
+      //x < qx1 && x + w > qx0 && y < qy1 && y + h > qy0
+      __m128i hit = _mm_and_si128(
+        _mm_and_si128(_mm_cmpgt_epi32(qx1, x),
+                      _mm_cmpgt_epi32(_mm_add_epi32(x, w), qx0)),
+        _mm_and_si128(_mm_cmpgt_epi32(qy1, y),
+                      _mm_cmpgt_epi32(_mm_add_epi32(y, h), qy0)));
+
+      uint64_t bits = (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(hit));
+      mask[i / 64] |= bits << (i % 64);
+    }
+    return i;
+  }
+#endif
+
+#ifdef AABB_HAVE_AVX2
+  /**
+   * Test rects eight at a time
+   * @param  query the rect to test
+   * @param  rects the rects
+   * @param  count the number of rects
+   * @param  mask  the hit words (zeroed)
+   * @return       the number of rects tested
+   */
+  __attribute__((target("avx2")))
+  static size_t overlap_avx2(const SDL_Rect& query,
+                             const SDL_Rect* rects,
+                             size_t count,
+                             uint64_t* mask) {
+    const __m256i qx0 = _mm256_set1_epi32(query.x);
+    const __m256i qy0 = _mm256_set1_epi32(query.y);
+    const __m256i qx1 = _mm256_set1_epi32(query.x + query.w);
+    const __m256i qy1 = _mm256_set1_epi32(query.y + query.h);
+
+    size_t i = 0;
+    for (; (i + 8) <= count; i += 8) {
+      //rect n in the low lane, rect n + 4 in the high lane, so the
+      //per lane transpose leaves the eight rects in order
+      const __m128i* p = (const __m128i*)&rects[i];
+      __m256i r0 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(p)),
+                                           _mm_loadu_si128(p + 4), 1);
+      __m256i r1 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(p + 1)),
+                                           _mm_loadu_si128(p + 5), 1);
+      __m256i r2 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(p + 2)),
+                                           _mm_loadu_si128(p + 6), 1);
+      __m256i r3 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(p + 3)),
+                                           _mm_loadu_si128(p + 7), 1);
+
+      __m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+      __m256i t1 = _mm256_unpacklo_epi32(r2, r3);
+      __m256i t2 = _mm256_unpackhi_epi32(r0, r1);
+      __m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+
+      __m256i x = _mm256_unpacklo_epi64(t0, t1);
+      __m256i y = _mm256_unpackhi_epi64(t0, t1);
+      __m256i w = _mm256_unpacklo_epi64(t2, t3);
+      __m256i h = _mm256_unpackhi_epi64(t2, t3);
+
+      __m256i hit = _mm256_and_si256(
+        _mm256_and_si256(_mm256_cmpgt_epi32(qx1, x),
+                         _mm256_cmpgt_epi32(_mm256_add_epi32(x, w), qx0)),
+        _mm256_and_si256(_mm256_cmpgt_epi32(qy1, y),
+                         _mm256_cmpgt_epi32(_mm256_add_epi32(y, h), qy0)));
+
+      uint64_t bits = (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(hit));
+      mask[i / 64] |= bits << (i % 64);
+    }
+    return i;
+  }
+#endif
+
+  /**
+   * Whether a kernel can run on this machine
+   * @param  kernel the kernel
+   * @return        whether it is available
+   */
+  bool aabb_kernel_available(aabb_kernel_t kernel) {
+    switch (kernel) {
+    case AABB_KERNEL_SCALAR:
+      return true;
+    case AABB_KERNEL_SSE2:
+#ifdef AABB_HAVE_SSE2
+      return true;
+#else
+      return false;
+#endif
+    case AABB_KERNEL_AVX2:
+#ifdef AABB_HAVE_AVX2
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+    }
+    return false;
+  }
+
+  /**
+   * Get the fastest kernel available on this machine
+   * @return the kernel used by aabb_overlap_mask
+   */
+  aabb_kernel_t aabb_best_kernel() {
+    static const aabb_kernel_t best =
+      aabb_kernel_available(AABB_KERNEL_AVX2) ? AABB_KERNEL_AVX2 :
+      aabb_kernel_available(AABB_KERNEL_SSE2) ? AABB_KERNEL_SSE2 :
+                                                AABB_KERNEL_SCALAR;
+    return best;
+  }
+
+  /**
+   * Test rects with a kernel, the remainder one at a time
+   * @param kernel the kernel to use (scalar if it isn't available)
+   * @param query  the rect to test
+   * @param rects  the rects
+   * @param count  the number of rects
+   * @param mask   the hit words (zeroed)
+   */
+  static void overlap_kernel(aabb_kernel_t kernel,
+                             const SDL_Rect& query,
+                             const SDL_Rect* rects,
+                             size_t count,
+                             uint64_t* mask) {
+    //vector kernels handle whole batches, the remainder is done one at a time
+    size_t done = 0;
+#ifdef AABB_HAVE_AVX2
+    if ((kernel == AABB_KERNEL_AVX2) && aabb_kernel_available(AABB_KERNEL_AVX2)) {
+      done = overlap_avx2(query, rects, count, mask);
+    }
+#endif
+#ifdef AABB_HAVE_SSE2
+    if ((kernel == AABB_KERNEL_SSE2) ||
+        ((kernel == AABB_KERNEL_AVX2) && (done == 0))) {
+      done = overlap_sse2(query, rects, count, mask);
+    }
+#endif
+    overlap_scalar(query, rects, done, count, mask);
+  }
+
+  /**
+   * Get the name of a kernel
+   * @param  kernel the kernel
+   * @return        the name
+   */
+  const char* aabb_kernel_name(aabb_kernel_t kernel) {
+    switch (kernel) {
+    case AABB_KERNEL_SCALAR: return "scalar";
+    case AABB_KERNEL_SSE2:   return "sse2";
+    case AABB_KERNEL_AVX2:   return "avx2";
+    }
+    return "unknown";
+  }
+
+  /**
+   * Test one rect against a packed array of rects (touching edges don't overlap)
+   * @param  query  the rect to test
+   * @param  rects  the rects
+   * @param  count  the number of rects
+   * @param  mask   hit bits, rect i is bit (i % 64) of word (i / 64) (resized)
+   * @return        the number of hits
+   */
+  size_t aabb_overlap_mask(const SDL_Rect& query,
+                           const SDL_Rect* rects,
+                           size_t count,
+                           std::vector<uint64_t>& mask) {
+    return aabb_overlap_mask(aabb_best_kernel(), query, rects, count, mask);
+  }
+
+  /**
+   * Test one rect against a packed array of rects with a specific kernel
+   * (falls back to scalar if the kernel isn't available)
+   * @param  kernel the kernel to use
+   * @param  query  the rect to test
+   * @param  rects  the rects
+   * @param  count  the number of rects
+   * @param  mask   hit bits, rect i is bit (i % 64) of word (i / 64) (resized)
+   * @return        the number of hits
+   */
+  size_t aabb_overlap_mask(aabb_kernel_t kernel,
+                           const SDL_Rect& query,
+                           const SDL_Rect* rects,
+                           size_t count,
+                           std::vector<uint64_t>& mask) {
+    mask.assign((count + 63) / 64, 0);
+    overlap_kernel(kernel, query, rects, count, mask.data());
+
+    size_t hits = 0;
+    for (uint64_t word : mask) {
+      hits += popcount(word);
+    }
+    return hits;
+  }
+
+  /**
+   * Whether one rect overlaps any of a packed array of rects
+   * (short lists stop at the first hit, longer ones are batched 64 at a time)
+   * @param  query the rect to test
+   * @param  rects the rects
+   * @param  count the number of rects
+   * @return       whether there is an overlap
+   */
+  bool aabb_overlap_any(const SDL_Rect& query, const SDL_Rect* rects, size_t count) {
+    if (count <= AABB_SCALAR_MAX) {
+      for (size_t i=0; i<count; i++) {
+        if (rect_overlaps(rects[i], query)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    //one mask word per batch (no buffer), stop after the first batch with a hit
+    aabb_kernel_t kernel = aabb_best_kernel();
+    for (size_t start=0; start<count; start+=64) {
+      uint64_t word = 0;
+      overlap_kernel(kernel, query, rects + start, std::min(count - start, (size_t)64), &word);
+      if (word) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_AABB_BATCH_H
+#define _DIVEBAR_COMMON_AABB_BATCH_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace common {
+
+  //lists this short are checked one rect at a time by aabb_overlap_any
+  //(stopping at the first hit beats batching them)
+  #define AABB_SCALAR_MAX 16
+
+  /*
+   * Implementations of the batch overlap test
+   */
+  enum aabb_kernel_t {
+    AABB_KERNEL_SCALAR,
+    AABB_KERNEL_SSE2,
+    AABB_KERNEL_AVX2
+  };
+
+  /**
+   * Whether a kernel can run on this machine
+   * @param  kernel the kernel
+   * @return        whether it is available
+   */
+  bool aabb_kernel_available(aabb_kernel_t kernel);
+
+  /**
+   * Get the fastest kernel available on this machine
+   * @return the kernel used by aabb_overlap_mask
+   */
+  aabb_kernel_t aabb_best_kernel();
+
+  /**
+   * Get the name of a kernel
+   * @param  kernel the kernel
+   * @return        the name
+   */
+  const char* aabb_kernel_name(aabb_kernel_t kernel);
+
+  /**
+   * Test one rect against a packed array of rects (touching edges don't overlap)
+   * @param  query  the rect to test
+   * @param  rects  the rects
+   * @param  count  the number of rects
+   * @param  mask   hit bits, rect i is bit (i % 64) of word (i / 64) (resized)
+   * @return        the number of hits
+   */
+  size_t aabb_overlap_mask(const SDL_Rect& query,
+                           const SDL_Rect* rects,
+                           size_t count,
+                           std::vector<uint64_t>& mask);
+
+  /**
+   * Test one rect against a packed array of rects with a specific kernel
+   * (falls back to scalar if the kernel isn't available)
+   * @param  kernel the kernel to use
+   * @param  query  the rect to test
+   * @param  rects  the rects
+   * @param  count  the number of rects
+   * @param  mask   hit bits, rect i is bit (i % 64) of word (i / 64) (resized)
+   * @return        the number of hits
+   */
+  size_t aabb_overlap_mask(aabb_kernel_t kernel,
+                           const SDL_Rect& query,
+                           const SDL_Rect* rects,
+                           size_t count,
+                           std::vector<uint64_t>& mask);
+
+  /**
+   * Whether one rect overlaps any of a packed array of rects
+   * (short lists stop at the first hit, longer ones are batched 64 at a time)
+   * @param  query the rect to test
+   * @param  rects the rects
+   * @param  count the number of rects
+   * @return       whether there is an overlap
+   */
+  bool aabb_overlap_any(const SDL_Rect& query, const SDL_Rect* rects, size_t count);
+
+  /**
+   * Whether a bit is set in a hit mask
+   * @param  mask the mask
+   * @param  i    the rect index
+   * @return      whether rect i was hit
+   */
+  inline bool aabb_mask_test(const std::vector<uint64_t>& mask, size_t i) {
+    return (mask[i / 64] >> (i % 64)) & 1;
+  }
+
+}
+
+#endif /*_DIVEBAR_COMMON_AABB_BATCH_H*/
@@ -35,7 +35,11 @@ namespace common {
       frame_delay(frame_delay),
       frame_delay_counter(frame_delay),
       flipped(false),
-      once(once) {}
+      once(once),
+      store(),
+      store_handle({0,0}) {
+    add_kind(COMPONENT_KIND_ANIM);
+  }
 
   /**
    * Copy constructor
@@ -48,11 +52,13 @@ namespace common {
       frame_height(other.frame_height),
       row_idx(other.row_idx),
       frames(other.frames),
-      current_frame(other.frames),
+      current_frame(other.get_frame()),
       frame_delay(other.frame_delay),
-      frame_delay_counter(other.frame_delay_counter),
+      frame_delay_counter(other.get_delay_counter()),
       flipped(other.flipped),
-      once(other.once) {}
+      once(other.once),
+      store(),
+      store_handle({0,0}) {}
 
   /**
    * Assignment operator (shares image)
@@ -64,14 +70,27 @@ namespace common {
     this->frame_height = other.frame_height;
     this->row_idx = other.row_idx;
     this->frames = other.frames;
-    this->current_frame = other.current_frame;
+    this->current_frame = other.get_frame();
     this->frame_delay = other.frame_delay;
-    this->frame_delay_counter = other.frame_delay_counter;
+    this->frame_delay_counter = other.get_delay_counter();
     this->flipped = other.flipped;
     this->once = other.once;
+    if (store) {
+      store->set_animation(store_handle,frames,frame_delay,once);
+      store->set_anim_state(store_handle,current_frame,frame_delay_counter);
+    }
     return *this;
   }
 
+  /**
+   * Destructor (releases the store entry)
+   */
+  anim_t::~anim_t() {
+    if (store) {
+      store->remove(store_handle);
+    }
+  }
+
   /**
    * Load any resources for this component
    * @param renderer the sdl renderer for loading images
@@ -81,6 +100,15 @@ namespace common {
   void anim_t::load(SDL_Renderer& renderer,
                     const common::component_t&,
                     common::shared_resources& resources) {
+    //move the frame state into the level's store (advanced by its animation pass)
+    if (!store) {
+      store = this->get_entity_store();
+      if (store) {
+        store_handle = store->add(this->get_bounds(), COMPONENT_VISIBLE);
+        store->set_animation(store_handle,frames,frame_delay,once);
+        store->set_anim_state(store_handle,current_frame,frame_delay_counter);
+      }
+    }
     component_t::load_children(renderer,resources);
   }
 
@@ -89,8 +117,12 @@ namespace common {
    * @param parent the parent of the animation
    */
   void anim_t::update(component_t& parent) {
+    if (store) {
+      //advanced with the rest of the level at the end of the tick
+      store->mark_anim_active(store_handle);
+
     //update if not single cycle or not on final frame or not at full delay
-    if (!once || (current_frame < (frames - 1)) || (frame_delay_counter > 0)) {
+    } else if (!once || (current_frame < (frames - 1)) || (frame_delay_counter > 0)) {
       //decrement delay counter
       this->frame_delay_counter--;
 
@@ -110,21 +142,26 @@ namespace common {
     //match the parent position
     this->set_position(parent_pos.x + (parent_pos.w / 2) - (current_pos.w / 2),
                        parent_pos.y + (parent_pos.h / 2) - (current_pos.h / 2));
+    if (store) {
+      store->set_bounds(store_handle,this->get_bounds());
+    }
   }
 
   /**
    * Render this animation
    * @param renderer the sdl renderer
    * @param camera   the current camera
+   * @param alpha    progress (0-1) between the last tick and the next
    */
   void anim_t::render(SDL_Renderer& renderer,
-                      const SDL_Rect& camera) const {
+                      const SDL_Rect& camera,
+                      float alpha) const {
     //location to sample in sprite sheet
-    SDL_Rect sample_bounds = {(int)(current_frame * frame_width),
+    SDL_Rect sample_bounds = {(int)(get_frame() * frame_width),
                               (int)(row_idx * frame_height),
                               frame_width, frame_height};
 
-    const SDL_Rect& current_bounds = this->get_bounds();
+    SDL_Rect current_bounds = this->get_interpolated_bounds(alpha);
 
     //set the position to render the animation frame,
     //adjust by camera and by image size
@@ -136,6 +173,19 @@ namespace common {
     this->image->render_copy(renderer,sample_bounds,render_bounds,flipped);
   }
 
+  /**
+   * Whether this animation is currently visible to the camera
+   * (uses the store's cull pass once loaded into a level)
+   * @param camera the current camera
+   * @return whether the animation is visible
+   */
+  bool anim_t::is_visible(const SDL_Rect& camera) const {
+    if (store) {
+      return store->is_visible(store_handle);
+    }
+    return component_t::is_visible(camera);
+  }
+
   /**
    * Set the animation flipped
    * @param  flipped flip the animation
@@ -156,8 +206,12 @@ namespace common {
    * Reset the animation
    */
   void anim_t::reset_animation() {
-    this->frame_delay_counter = this->frame_delay;
-    this->current_frame = 0;
+    if (store) {
+      store->reset_animation(store_handle);
+    } else {
+      this->frame_delay_counter = this->frame_delay;
+      this->current_frame = 0;
+    }
   }
 
   /**
@@ -165,8 +219,8 @@ namespace common {
    * @return whether the cycle is complete
    */
   bool anim_t::anim_complete() const {
-    return (current_frame == (frames - 1)) &&
-           (frame_delay_counter == 0);
+    return (get_frame() == (frames - 1)) &&
+           (get_delay_counter() == 0);
   }
 
   /**
@@ -174,6 +228,6 @@ namespace common {
    * @return the number of update calls left in the cycle
    */
   int anim_t::cycle_duration_remaining() const {
-    return frame_delay_counter + (frame_delay * (frames - current_frame - 1));
+    return get_delay_counter() + (frame_delay * (frames - get_frame() - 1));
   }
 }
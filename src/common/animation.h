@@ -14,6 +14,7 @@
 #include "component.h"
 #include "shared_resources.h"
 #include "image.h"
+#include "entity_store.h"
 
 namespace common {
 
@@ -43,6 +44,27 @@ namespace common {
     //play the animation once, pause until reset
     bool once;
 
+    //the level entity store holding the frame state once loaded (optional)
+    std::shared_ptr<entity_store_t> store;
+    //the entry in the store
+    entity_handle_t store_handle;
+
+    /**
+     * Get the current frame
+     * @return the frame
+     */
+    int get_frame() const {
+      return store ? store->get_anim_frame(store_handle) : current_frame;
+    }
+
+    /**
+     * Get the ticks left on the current frame
+     * @return the frame delay counter
+     */
+    int get_delay_counter() const {
+      return store ? store->get_anim_counter(store_handle) : frame_delay_counter;
+    }
+
     /**
      * Update the animation
      * @param parent the parent of the animation
@@ -63,11 +85,17 @@ namespace common {
      * Render this animation
      * @param renderer the sdl renderer
      * @param camera   the current camera
+     * @param alpha    progress (0-1) between the last tick and the next
      */
     void render(SDL_Renderer& renderer,
-                const SDL_Rect& camera) const override;
+                const SDL_Rect& camera,
+                float alpha) const override;
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_ANIM;
+    typedef anim_t component_kind_owner_t;
+
     /**
      * Constructor
      */
@@ -102,6 +130,19 @@ namespace common {
      */
     anim_t& operator=(const anim_t& other);
 
+    /**
+     * Destructor (releases the store entry)
+     */
+    ~anim_t();
+
+    /**
+     * Whether this animation is currently visible to the camera
+     * (uses the store's cull pass once loaded into a level)
+     * @param camera the current camera
+     * @return whether the animation is visible
+     */
+    bool is_visible(const SDL_Rect& camera) const override;
+
     /**
      * Set the animation flipped
      * @param  flipped flip the animation
@@ -0,0 +1,63 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "arena.h"
+#include <stdint.h>
+#include <algorithm>
+
+namespace common {
+
+  thread_local arena_t* arena_t::active = nullptr;
+
+  /**
+   * Constructor
+   */
+  arena_t::arena_t()
+    : blocks(),
+      head(nullptr),
+      end(nullptr),
+      used(0) {}
+
+  /**
+   * Allocate memory
+   * @param  size  bytes to allocate
+   * @param  align alignment (power of two)
+   * @return       the memory (valid until the arena is destroyed)
+   */
+  void* arena_t::allocate(size_t size, size_t align) {
+    uintptr_t aligned = ((uintptr_t)head + (align - 1)) & ~(uintptr_t)(align - 1);
+
+    if (!head || ((aligned + size) > (uintptr_t)end)) {
+      //start a new block (oversized requests get a block to themselves)
+      size_t block_size = std::max((size_t)ARENA_BLOCK_SIZE, size + align);
+      blocks.push_back(std::unique_ptr<char[]>(new char[block_size]));
+      head = blocks.back().get();
+      end = head + block_size;
+      aligned = ((uintptr_t)head + (align - 1)) & ~(uintptr_t)(align - 1);
+    }
+
+    head = (char*)(aligned + size);
+    used += size;
+    return (void*)aligned;
+  }
+
+  /**
+   * Constructor
+   * @param arena the arena to allocate from
+   */
+  arena_scope_t::arena_scope_t(arena_t& arena)
+    : prev(arena_t::active) {
+    arena_t::active = &arena;
+  }
+
+  /**
+   * Destructor, restores the previous arena
+   */
+  arena_scope_t::~arena_scope_t() {
+    arena_t::active = prev;
+  }
+
+}
@@ -0,0 +1,94 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_ARENA_H
+#define _DIVEBAR_COMMON_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace common {
+
+  //size of an arena block (larger requests get their own block)
+  #define ARENA_BLOCK_SIZE (64 * 1024)
+
+  /*
+   * Monotonic allocator, memory is only released (all at once)
+   * when the arena is destroyed
+   */
+  class arena_t {
+  private:
+    //allocated blocks
+    std::vector<std::unique_ptr<char[]>> blocks;
+    //bump pointer into the current block
+    char* head;
+    //end of the current block
+    char* end;
+    //total bytes handed out
+    size_t used;
+
+    //the arena new allocations come from (see arena_scope_t)
+    static thread_local arena_t* active;
+
+    friend class arena_scope_t;
+
+  public:
+    /**
+     * Constructor
+     */
+    arena_t();
+    arena_t(const arena_t&) = delete;
+    arena_t& operator=(const arena_t&) = delete;
+
+    /**
+     * Allocate memory
+     * @param  size  bytes to allocate
+     * @param  align alignment (power of two)
+     * @return       the memory (valid until the arena is destroyed)
+     */
+    void* allocate(size_t size, size_t align);
+
+    /**
+     * Get the number of bytes handed out
+     * @return bytes used
+     */
+    size_t bytes_used() const { return used; }
+
+    /**
+     * Get the arena allocations are currently routed to
+     * @return the active arena (or nullptr for the heap)
+     */
+    static arena_t* current() { return active; }
+  };
+
+  /*
+   * Route arena aware allocations (components) to an arena
+   * for the lifetime of the scope
+   */
+  class arena_scope_t {
+  private:
+    //the arena active before this scope
+    arena_t* prev;
+
+  public:
+    /**
+     * Constructor
+     * @param arena the arena to allocate from
+     */
+    explicit arena_scope_t(arena_t& arena);
+    arena_scope_t(const arena_scope_t&) = delete;
+    arena_scope_t& operator=(const arena_scope_t&) = delete;
+
+    /**
+     * Destructor, restores the previous arena
+     */
+    ~arena_scope_t();
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_ARENA_H*/
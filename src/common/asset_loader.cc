@@ -0,0 +1,273 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "asset_loader.h"
+#include "launch_exception.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+
+namespace common {
+
+  /**
+   * Constructor
+   * @param renderer the renderer to upload to
+   * @param path     the file to load
+   * @param atlas    the atlas to pack into (or nullptr)
+   */
+  image_request_t::image_request_t(SDL_Renderer& renderer,
+                                   const std::string& path,
+                                   std::shared_ptr<texture_atlas_t> atlas)
+    : path(path),
+      renderer(&renderer),
+      atlas(atlas),
+      lock(),
+      decoded(),
+      state(IMAGE_REQUEST_QUEUED),
+      surface(NULL),
+      error(),
+      texture(NULL),
+      page(),
+      region{0,0,0,0} {}
+
+  //free anything not handed over
+  image_request_t::~image_request_t() {
+    if (surface != NULL) {
+      SDL_FreeSurface(surface);
+    }
+    //packed textures belong to their page
+    if ((texture != NULL) && !page) {
+      SDL_DestroyTexture(texture);
+    }
+  }
+
+  /**
+   * Decode the file if nobody has started yet (any thread)
+   */
+  void image_request_t::decode() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (state != IMAGE_REQUEST_QUEUED) {
+        return;
+      }
+      state = IMAGE_REQUEST_DECODING;
+    }
+
+    //decode without holding the lock
+    SDL_Surface* pixels = IMG_Load(path.c_str());
+    if (pixels != NULL) {
+      SDL_SetColorKey(pixels,SDL_TRUE,SDL_MapRGB(pixels->format,0,0xFF,0xFF));
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      surface = pixels;
+      if (pixels == NULL) {
+        error = "failed to load image: " + path;
+      }
+      state = IMAGE_REQUEST_DECODED;
+    }
+    decoded.notify_all();
+  }
+
+  /**
+   * Create the texture, decoding first if needed (render thread)
+   * throws a launch_exception if the image could not be loaded
+   */
+  void image_request_t::upload() {
+    //needed before the workers got to it, decode here
+    decode();
+
+    std::unique_lock<std::mutex> guard(lock);
+    decoded.wait(guard, [this] { return state >= IMAGE_REQUEST_DECODED; });
+    if (state == IMAGE_REQUEST_UPLOADED) {
+      return;
+    }
+    if (!error.empty()) {
+      throw launch_exception(error);
+    }
+
+    //share an atlas page if it fits, otherwise a texture of its own
+    if (atlas) {
+      page = atlas->add(*surface, region);
+      if (page) {
+        texture = page->get_texture();
+      }
+    }
+    if (texture == NULL) {
+      texture = SDL_CreateTextureFromSurface(renderer,surface);
+      if (texture == NULL) {
+        //throw an exception with sdl error detail
+        throw launch_exception("could not create texture: " + std::string(SDL_GetError()));
+      }
+      region = {0,0,surface->w,surface->h};
+    }
+
+    SDL_FreeSurface(surface);
+    surface = NULL;
+    state = IMAGE_REQUEST_UPLOADED;
+  }
+
+  /**
+   * Give up a load that will never be decoded (loader shutting down)
+   */
+  void image_request_t::cancel() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (state != IMAGE_REQUEST_QUEUED) {
+        return;
+      }
+      error = "image load cancelled: " + path;
+      state = IMAGE_REQUEST_DECODED;
+    }
+    decoded.notify_all();
+  }
+
+  /**
+   * Whether the texture has been created
+   * @return whether upload finished
+   */
+  bool image_request_t::is_uploaded() {
+    std::lock_guard<std::mutex> guard(lock);
+    return state == IMAGE_REQUEST_UPLOADED;
+  }
+
+  /**
+   * Whether decoding finished without an image (the error is thrown by upload)
+   * @return whether the load failed
+   */
+  bool image_request_t::failed() {
+    std::lock_guard<std::mutex> guard(lock);
+    return !error.empty();
+  }
+
+  /**
+   * Take the uploaded texture
+   * @param bounds the size of the image (set)
+   * @param origin where the image is in the texture (set)
+   * @param owner  the atlas page owning the texture (set, nullptr if the caller owns it)
+   * @return       the texture
+   */
+  SDL_Texture* image_request_t::take_texture(SDL_Rect& bounds,
+                                             SDL_Point& origin,
+                                             std::shared_ptr<atlas_page_t>& owner) {
+    std::lock_guard<std::mutex> guard(lock);
+    SDL_Texture* taken = texture;
+    texture = NULL;
+    bounds = {0,0,region.w,region.h};
+    origin = {region.x,region.y};
+    owner = std::move(page);
+    return taken;
+  }
+
+  /**
+   * Constructor, starts the workers
+   */
+  asset_loader_t::asset_loader_t()
+    : workers(),
+      lock(),
+      work_available(),
+      queued(),
+      decoded(),
+      stopping(false),
+      atlas() {
+    //one core stays with the game (hardware_concurrency may report 0)
+    unsigned int cores = std::thread::hardware_concurrency();
+    unsigned int count = std::min(std::max(cores, 2u) - 1, (unsigned int)ASSET_MAX_WORKERS);
+    for (unsigned int i=0; i<count; i++) {
+      workers.emplace_back(&asset_loader_t::work, this);
+    }
+  }
+
+  /**
+   * Destructor, stops the workers (queued loads are cancelled)
+   */
+  asset_loader_t::~asset_loader_t() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+      for (std::shared_ptr<image_request_t>& request : queued) {
+        request->cancel();
+      }
+      queued.clear();
+    }
+    work_available.notify_all();
+
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+  }
+
+  /**
+   * Decode requests until the loader stops
+   */
+  void asset_loader_t::work() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+      work_available.wait(guard, [this] { return stopping || !queued.empty(); });
+      if (stopping) {
+        return;
+      }
+
+      std::shared_ptr<image_request_t> request = queued.front();
+      queued.pop_front();
+
+      guard.unlock();
+      request->decode();
+      guard.lock();
+
+      decoded.push_back(request);
+    }
+  }
+
+  /**
+   * Start loading an image
+   * @param  renderer the renderer the image will be drawn with
+   * @param  path     the file to load
+   * @return          the image (its texture is created when ready or first used)
+   */
+  std::shared_ptr<image_t> asset_loader_t::load_image(SDL_Renderer& renderer,
+                                                      const std::string& path) {
+    if (!atlas) {
+      atlas = std::make_shared<texture_atlas_t>(renderer);
+    }
+
+    std::shared_ptr<image_request_t> request =
+      std::make_shared<image_request_t>(renderer, path, atlas);
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      queued.push_back(request);
+    }
+    work_available.notify_one();
+    return std::make_shared<image_t>(request);
+  }
+
+  /**
+   * Create textures for decoded images (call once per frame on the render thread)
+   * failed loads are skipped, they throw when the image is first used
+   * @param max the most textures to create
+   */
+  void asset_loader_t::upload_ready(size_t max) {
+    size_t uploaded = 0;
+    while (uploaded < max) {
+      std::shared_ptr<image_request_t> request;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (decoded.empty()) {
+          return;
+        }
+        request = decoded.front();
+        decoded.pop_front();
+      }
+
+      //skip images that were dropped, already drawn or failed
+      if ((request.use_count() > 1) && !request->is_uploaded() && !request->failed()) {
+        request->upload();
+        uploaded++;
+      }
+    }
+  }
+
+}
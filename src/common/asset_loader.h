@@ -0,0 +1,180 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_ASSET_LOADER_H
+#define _DIVEBAR_COMMON_ASSET_LOADER_H
+
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "image.h"
+#include "texture_atlas.h"
+
+namespace common {
+
+  //max decode threads (leaves a core for the game)
+  #define ASSET_MAX_WORKERS 4
+  //textures uploaded per frame by asset_loader_t::upload_ready
+  #define ASSET_UPLOADS_PER_FRAME 2
+
+  /*
+   * An image being loaded in the background, shared by the loader and the
+   * image_t waiting on it. Decoding may happen on any thread, the
+   * upload only on the render thread
+   */
+  class image_request_t {
+  private:
+    enum state_t {
+      IMAGE_REQUEST_QUEUED,
+      IMAGE_REQUEST_DECODING,
+      IMAGE_REQUEST_DECODED,
+      IMAGE_REQUEST_UPLOADED
+    };
+
+    //the file to load
+    std::string path;
+    //the renderer to upload to
+    SDL_Renderer* renderer;
+    //the atlas to pack into (nullptr for a texture of its own)
+    std::shared_ptr<texture_atlas_t> atlas;
+
+    //guards state, surface and error
+    std::mutex lock;
+    //signalled when decoding finishes
+    std::condition_variable decoded;
+    state_t state;
+    //the decoded pixels (until uploaded)
+    SDL_Surface* surface;
+    //why decoding failed (empty on success)
+    std::string error;
+
+    //the uploaded texture (owned by the image once taken unless packed)
+    SDL_Texture* texture;
+    //the atlas page the texture belongs to (if packed)
+    std::shared_ptr<atlas_page_t> page;
+    //where the image is in the texture
+    SDL_Rect region;
+
+  public:
+    /**
+     * Constructor
+     * @param renderer the renderer to upload to
+     * @param path     the file to load
+     * @param atlas    the atlas to pack into (or nullptr)
+     */
+    image_request_t(SDL_Renderer& renderer,
+                    const std::string& path,
+                    std::shared_ptr<texture_atlas_t> atlas);
+    image_request_t(const image_request_t&) = delete;
+    image_request_t& operator=(const image_request_t&) = delete;
+
+    //free anything not handed over
+    ~image_request_t();
+
+    /**
+     * Decode the file if nobody has started yet (any thread)
+     */
+    void decode();
+
+    /**
+     * Create the texture, decoding first if needed (render thread)
+     * throws a launch_exception if the image could not be loaded
+     */
+    void upload();
+
+    /**
+     * Give up a load that will never be decoded (loader shutting down)
+     */
+    void cancel();
+
+    /**
+     * Whether the texture has been created
+     * @return whether upload finished
+     */
+    bool is_uploaded();
+
+    /**
+     * Whether decoding finished without an image (the error is thrown by upload)
+     * @return whether the load failed
+     */
+    bool failed();
+
+    /**
+     * Take the uploaded texture
+     * @param bounds the size of the image (set)
+     * @param origin where the image is in the texture (set)
+     * @param owner  the atlas page owning the texture (set, nullptr if the caller owns it)
+     * @return       the texture
+     */
+    SDL_Texture* take_texture(SDL_Rect& bounds,
+                              SDL_Point& origin,
+                              std::shared_ptr<atlas_page_t>& owner);
+  };
+
+  /*
+   * Decodes images on a pool of worker threads so that loading doesn't
+   * block startup, textures are created later on the render thread
+   * a few per frame (or as soon as an image is first drawn)
+   */
+  class asset_loader_t {
+  private:
+    //decode threads
+    std::vector<std::thread> workers;
+    //guards the queues and stopping
+    std::mutex lock;
+    //signalled when work is queued or the loader stops
+    std::condition_variable work_available;
+    //requests waiting to be decoded
+    std::deque<std::shared_ptr<image_request_t>> queued;
+    //requests decoded but not yet uploaded
+    std::deque<std::shared_ptr<image_request_t>> decoded;
+    //whether the workers should exit
+    bool stopping;
+    //sheets and tilesets are packed here (created with the first load)
+    std::shared_ptr<texture_atlas_t> atlas;
+
+    /**
+     * Decode requests until the loader stops
+     */
+    void work();
+
+  public:
+    /**
+     * Constructor, starts the workers
+     */
+    asset_loader_t();
+    asset_loader_t(const asset_loader_t&) = delete;
+    asset_loader_t& operator=(const asset_loader_t&) = delete;
+
+    /**
+     * Destructor, stops the workers (queued loads are cancelled)
+     */
+    ~asset_loader_t();
+
+    /**
+     * Start loading an image
+     * @param  renderer the renderer the image will be drawn with
+     * @param  path     the file to load
+     * @return          the image (its texture is created when ready or first used)
+     */
+    std::shared_ptr<image_t> load_image(SDL_Renderer& renderer, const std::string& path);
+
+    /**
+     * Create textures for decoded images (call once per frame on the render thread)
+     * failed loads are skipped, they throw when the image is first used
+     * @param max the most textures to create
+     */
+    void upload_ready(size_t max=ASSET_UPLOADS_PER_FRAME);
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_ASSET_LOADER_H*/
@@ -6,10 +6,13 @@
 
 #include "component.h"
 #include "../state/entity/player.h"
-#ifndef __APPLE__
-#include <filesystem>
-#endif
 #include "keys.h"
+#include "sweep.h"
+#include "rect.h"
+#include "aabb_batch.h"
+#include "render_queue.h"
+#include <cstdlib>
+#include <algorithm>
 
 namespace common {
 
@@ -18,18 +21,34 @@ namespace common {
    * @param bounds the bounds of the component
    * @param flags  attributes
    * @param interaction_key the key to trigger player interaction (if applicable)
+   * @param resource_root the directory to load resources from
    */
   component_t::component_t(SDL_Rect&& bounds,
                            uint8_t flags,
                            SDL_Keycode interaction_key,
-                           const std::string& resource_dir_prefix)
+                           const resource_root_t* resource_root)
     : parent(nullptr),
+      child_id(0),
       children(),
+      slots(),
+      free_slots(),
+      removal_pending(false),
+      broadphase(),
+      interactions(),
+      interaction_owner(nullptr),
+      interaction_id(0),
       bounds(bounds),
+      prev_bounds(bounds),
       flags(flags),
+      kinds(0),
       interaction_key(interaction_key),
-      resource_dir_prefix(resource_dir_prefix),
-      can_interact(true) {
+      resource_root(resource_root),
+      can_interact(true),
+      render_layer(RENDER_LAYER_INHERIT),
+      render_cull(),
+      motion_solids(),
+      contacts(0),
+      snapped(false) {
 
     //add interaction key prompt child
     if ((flags & COMPONENT_INTERACTIVE) &&
@@ -44,12 +63,27 @@ namespace common {
    */
   component_t::component_t(const component_t& other)
     : parent(other.parent),
+      child_id(other.child_id),
       children(),
+      slots(),
+      free_slots(),
+      removal_pending(false),
+      broadphase(),
+      interactions(),
+      interaction_owner(nullptr),
+      interaction_id(0),
       bounds(other.bounds),
+      prev_bounds(other.prev_bounds),
       flags(other.flags),
+      kinds(other.kinds),
       interaction_key(other.interaction_key),
-      resource_dir_prefix(other.resource_dir_prefix),
-      can_interact(other.can_interact) {}
+      resource_root(other.resource_root),
+      can_interact(other.can_interact),
+      render_layer(other.render_layer),
+      render_cull(),
+      motion_solids(),
+      contacts(0),
+      snapped(false) {}
 
   /**
    * Assignment operator
@@ -57,11 +91,15 @@ namespace common {
    */
   component_t& component_t::operator=(const component_t& other) {
     this->parent = other.parent;
+    this->child_id = other.child_id;
     this->bounds = other.bounds;
+    this->prev_bounds = other.prev_bounds;
     this->flags = other.flags;
+    this->kinds = other.kinds;
     this->interaction_key = other.interaction_key;
-    this->resource_dir_prefix = other.resource_dir_prefix;
+    this->resource_root = other.resource_root;
     this->can_interact = other.can_interact;
+    this->render_layer = other.render_layer;
     return *this;
   }
 
@@ -71,24 +109,203 @@ namespace common {
   }
 
   /**
-   * Calculate collisions for a child
-   * @param idx the child to check
-   * @return whether the child collided with a solid component
+   * Allocate a component (from the active arena if there is one)
+   * @param  size the size of the component
+   * @return      the memory
    */
-  bool component_t::check_child_collisions(size_t idx) const {
-    if (children.at(idx)->flags & COMPONENT_COLLIDABLE) {
-      //resolve collisions
+  void* component_t::operator new(size_t size) {
+    arena_t* arena = arena_t::current();
+    size_t total = size + COMPONENT_ALLOC_HEADER;
+
+    char* mem = arena ? (char*)arena->allocate(total, COMPONENT_ALLOC_HEADER)
+                      : (char*)::operator new(total);
+
+    //remember where the memory came from
+    *(arena_t**)mem = arena;
+    return mem + COMPONENT_ALLOC_HEADER;
+  }
+
+  /**
+   * Free a component (no-op for arena memory, freed with the arena)
+   * @param p the component memory
+   */
+  void component_t::operator delete(void* p) {
+    if (!p) {
+      return;
+    }
+    char* mem = (char*)p - COMPONENT_ALLOC_HEADER;
+    if (!*(arena_t**)mem) {
+      ::operator delete(mem);
+    }
+  }
+
+  /**
+   * Destroy all children now (i.e. before an arena they live in is released)
+   */
+  void component_t::clear_children() {
+    children.clear();
+    slots.clear();
+    free_slots.clear();
+  }
+
+  /**
+   * Collect the solid rects of a child's siblings within an area
+   * @param child  the child (or nullptr for all children)
+   * @param area   the area to collect from
+   * @param solids the rects (appended)
+   */
+  void component_t::gather_child_solids(const component_t* child,
+                                        const SDL_Rect& area,
+                                        std::vector<SDL_Rect>& solids) const {
+    if (broadphase) {
+      //only check solid children sharing a cell
+      for (size_t slot : broadphase->query(area)) {
+        const component_t& other = *children[slots[slot].dense];
+        if ((&other != child) && other.is_solid()) {
+          other.solid_rects(area,solids);
+        }
+      }
+
+    } else {
       for (size_t i=0; i<children.size(); i++) {
-        //check for a collision
-        if ((i != idx) &&
-            children.at(i)->is_solid() &&
-            children.at(i)->collides_with(*children.at(idx))) {
-          //collision
-          return true;
+        if ((children[i].get() != child) && children[i]->is_solid()) {
+          children[i]->solid_rects(area,solids);
         }
       }
     }
-    return false;
+  }
+
+  /**
+   * Get the contacts made by a sweep
+   * @param  sweep the sweep
+   * @return       CONTACT_* flags
+   */
+  static uint8_t contact_flags(const sweep_result_t& sweep) {
+    if (sweep.time >= 1.0f) {
+      return 0;
+    }
+    return ((sweep.normal_y < 0) ? CONTACT_GROUND : 0) |
+           ((sweep.normal_y > 0) ? CONTACT_CEILING : 0) |
+           (sweep.normal_x ? CONTACT_WALL : 0);
+  }
+
+  /**
+   * Resolve a child's movement for this tick against its solid siblings
+   * @param child        the child
+   * @param old_position the bounds before the update
+   * @param gravity      gravity to apply (px)
+   */
+  void component_t::resolve_child_motion(component_t& child,
+                                         const SDL_Rect& old_position,
+                                         int gravity) {
+    //children have finished updating by now, so nothing else is using these
+    std::vector<SDL_Rect>& solids = motion_solids;
+
+    SDL_Rect moved = child.bounds;
+    child.contacts = 0;
+
+    //everything the child can reach this tick (+1px for contact probes)
+    SDL_Rect area = rect_expand(rect_union(old_position, moved), 1);
+    area.h += gravity;
+
+    //gather once, resolve everything against the same rects
+    solids.clear();
+    gather_child_solids(&child,area,solids);
+
+    if (child.snapped) {
+      //snaps step over geometry on purpose, only the destination has to be free
+      if (overlaps_any(moved,solids)) {
+        moved = old_position;
+      }
+
+    } else if ((moved.x != old_position.x) || (moved.y != old_position.y)) {
+      //sweep the update's move from where the child started (fast moves can't
+      //tunnel through thin solids) and slide (any resize applies from the start)
+      SDL_Rect start = {old_position.x, old_position.y, moved.w, moved.h};
+      sweep_result_t move = sweep_move(start,
+                                       moved.x - old_position.x,
+                                       moved.y - old_position.y,
+                                       solids);
+      moved = move.bounds;
+      child.contacts |= contact_flags(move);
+    }
+
+    //fall until contact
+    if (gravity) {
+      sweep_result_t fall = sweep_move(moved,0,gravity,solids);
+      moved = fall.bounds;
+      child.contacts |= contact_flags(fall);
+    }
+
+    child.bounds = moved;
+    child.bounds_changed();
+  }
+
+  /**
+   * Add a child to the broadphase (if it is solid)
+   * @param child the child
+   */
+  void component_t::broadphase_insert(const component_t& child) {
+    if (broadphase && child.is_solid()) {
+      broadphase->insert(id_slot(child.child_id), child.bounds);
+    }
+  }
+
+  /**
+   * Notify the parent broadphase that the bounds changed
+   */
+  void component_t::bounds_changed() {
+    if (parent && parent->broadphase) {
+      parent->broadphase->update(id_slot(child_id), bounds);
+    }
+    if (interaction_owner) {
+      interaction_owner->moved(interaction_id, bounds);
+    }
+  }
+
+  /**
+   * Track solid children in a uniform grid so that collision
+   * checks only test siblings sharing a cell
+   * @param cell_dim the grid cell size (px)
+   */
+  void component_t::enable_broadphase(int cell_dim) {
+    broadphase = std::make_unique<spatial_hash_t>(cell_dim);
+    for (size_t i=0; i<children.size(); i++) {
+      broadphase_insert(*children[i]);
+    }
+  }
+
+  /**
+   * Index the interactive components in this subtree (when children
+   * are loaded, and as children are added after that) so that the
+   * player only checks nearby ones
+   * @param cell_dim the grid cell size (px)
+   */
+  void component_t::enable_interactions(int cell_dim) {
+    interactions = std::make_unique<interaction_index_t>(cell_dim);
+  }
+
+  /**
+   * Register the interactive components below this one
+   * @param index the index to register with
+   */
+  void component_t::register_interactive_children(interaction_index_t& index) {
+    for (size_t i=0; i<children.size(); i++) {
+      register_interactive_child(index, *children[i]);
+    }
+  }
+
+  /**
+   * Register a child and the interactive components below it
+   * @param index the index to register with
+   * @param child the child
+   */
+  void component_t::register_interactive_child(interaction_index_t& index, component_t& child) {
+    if ((child.flags & COMPONENT_INTERACTIVE) && !child.interaction_owner) {
+      child.interaction_owner = &index;
+      child.interaction_id = index.add(child, *this, child.can_interact);
+    }
+    child.register_interactive_children(index);
   }
 
   /**
@@ -96,32 +313,34 @@ namespace common {
    * @param player the player
    */
   void component_t::update_interactive_components(state::entity::player_t& player) {
-    for (size_t i=0; i<children.size(); i++) {
-      //filter for interactive components only
-      if (children.at(i)->flags & COMPONENT_INTERACTIVE) {
-        //check if this child is within the interactive range
-        bool prev = children.at(i)->can_interact;
-        const SDL_Rect& child_bounds = children.at(i)->bounds;
-
-        //check if the player interacts
-        children.at(i)->can_interact = ((child_bounds.x < (player.bounds.x + player.bounds.w)) &&
-                                       ((child_bounds.x + child_bounds.w) > player.bounds.x) &&
-                                       (child_bounds.y < (player.bounds.y + player.bounds.h)) &&
-                                       ((child_bounds.y + child_bounds.h) > player.bounds.y));
-
-        //check if the interaction is automatic
-        if ((children.at(i)->flags & COMPONENT_AUTO_INTERACT) &&
-            (children.at(i)->can_interact && !prev) ){
-          children.at(i)->interact_entered(*this,player);
-        }
+    interaction_index_t& index = *interactions;
+    const std::vector<size_t>& prev_in_range = index.begin_update();
+    std::vector<size_t>& in_range = index.get_in_range();
+
+    //find the components the player overlaps
+    for (size_t id : index.overlapping(player.bounds)) {
+      index.set_near(id, true);
+      in_range.push_back(id);
+    }
 
-        //check for exit
-        if (!children.at(i)->can_interact && prev) {
-          children.at(i)->interact_exited(*this,player);
-        }
+    //check for exit
+    for (size_t id : prev_in_range) {
+      if (!index.is_near(id)) {
+        component_t& child = index.get_component(id);
+        child.can_interact = false;
+        child.interact_exited(index.get_parent(id),player);
+      }
+    }
+
+    for (size_t id : in_range) {
+      component_t& child = index.get_component(id);
+      bool prev = child.can_interact;
+      child.can_interact = true;
+
+      //check if the interaction is automatic
+      if ((child.flags & COMPONENT_AUTO_INTERACT) && !prev) {
+        child.interact_entered(index.get_parent(id),player);
       }
-      //recurse down component tree
-      children.at(i)->update_interactive_components(player);
     }
   }
 
@@ -132,35 +351,110 @@ namespace common {
    */
   void component_t::interactive_components_handle_event(const SDL_Event& e,
                                                         state::entity::player_t& player) {
-    for (size_t i=0; i<children.size(); i++) {
-      //check for components that are manually interactive
-      if ((children.at(i)->flags & COMPONENT_INTERACTIVE) &&
-          !(children.at(i)->flags & COMPONENT_AUTO_INTERACT)) {
+    if (e.type != SDL_KEYDOWN) {
+      return;
+    }
 
-        if ((e.type == SDL_KEYDOWN) &&
-            children.at(i)->can_interact &&
-            (e.key.keysym.sym == children.at(i)->interaction_key)) {
-          children.at(i)->interact_entered(*this,player);
-        }
-      }
+    //only components in range can be interacted with
+    interaction_index_t& index = *interactions;
+    for (size_t id : index.get_in_range()) {
+      component_t& child = index.get_component(id);
 
-      //recurse
-      children.at(i)->interactive_components_handle_event(e,player);
+      //check for components that are manually interactive
+      if (!(child.flags & COMPONENT_AUTO_INTERACT) &&
+          child.can_interact &&
+          (e.key.keysym.sym == child.interaction_key)) {
+        child.interact_entered(index.get_parent(id),player);
+      }
     }
   }
 
   /**
    * Add a child to this component (assumes ownership)
    * @param c the child
-   * @return the index of the child
+   * @return the id of the child (stays valid until the child is removed)
    */
   size_t component_t::add_child(std::unique_ptr<component_t> c) {
+    //find a slot for the id
+    uint32_t slot;
+    if (!free_slots.empty()) {
+      slot = free_slots.back();
+      free_slots.pop_back();
+    } else {
+      slot = (uint32_t)slots.size();
+      slots.push_back({0,0});
+    }
+    slots[slot].dense = (uint32_t)children.size();
+
     //set the parent of the child
     c->parent = this;
+    c->child_id = ((size_t)slots[slot].generation << CHILD_ID_SLOT_BITS) | slot;
     //inherit resource location
-    c->resource_dir_prefix = this->resource_dir_prefix;
+    c->resource_root = this->resource_root;
     children.push_back(std::move(c));
-    return children.size() - 1;
+    broadphase_insert(*children.back());
+
+    //the nearest index above owns the new subtree (so children spawned
+    //after load_children are found too)
+    for (component_t* owner = this; owner; owner = owner->parent) {
+      if (owner->interactions) {
+        register_interactive_child(*owner->interactions, *children.back());
+        break;
+      }
+    }
+    return children.back()->child_id;
+  }
+
+  /**
+   * Unregister this subtree from any interaction index
+   */
+  void component_t::release_interactions() {
+    if (interaction_owner) {
+      interaction_owner->remove(interaction_id);
+      interaction_owner = nullptr;
+    }
+    for (size_t i=0; i<children.size(); i++) {
+      children[i]->release_interactions();
+    }
+  }
+
+  /**
+   * Remove children marked for removal anywhere in this subtree
+   * (compacts each affected child list in one pass, ids of the
+   * remaining children stay valid)
+   */
+  void component_t::remove_marked_children() {
+    if (!removal_pending) {
+      return;
+    }
+    removal_pending = false;
+
+    size_t kept = 0;
+    for (size_t i=0; i<children.size(); i++) {
+      uint32_t slot = id_slot(children[i]->child_id);
+
+      if (children[i]->flags & COMPONENT_REMOVE) {
+        //drop the child and retire its id
+        if (broadphase) {
+          broadphase->remove(slot);
+        }
+        children[i]->release_interactions();
+        children[i].reset();
+        slots[slot].generation++;
+        free_slots.push_back(slot);
+        continue;
+      }
+
+      children[i]->remove_marked_children();
+
+      //slide down over removed children (keeps render order)
+      if (kept != i) {
+        children[kept] = std::move(children[i]);
+        slots[slot].dense = (uint32_t)kept;
+      }
+      kept++;
+    }
+    children.resize(kept);
   }
 
   /**
@@ -183,46 +477,47 @@ namespace common {
   void component_t::update(component_t& parent) {
     //update each child
     for (size_t i=0; i<children.size(); i++) {
-      update_child(i);
+      update_child(*children[i]);
     }
   }
 
   /**
    * Update a single child
-   * @param idx the index of the child
+   * @param idx the id of the child
    */
   void component_t::update_child(size_t idx) {
-    //TODO remove components marked
+    update_child(child_at(idx));
+  }
 
-    SDL_Rect old_position = children.at(idx)->bounds;
+  /**
+   * Update a single child
+   * @param child the child
+   */
+  void component_t::update_child(component_t& child) {
+    SDL_Rect old_position = child.bounds;
+
+    //keep the starting position for render interpolation
+    child.prev_bounds = old_position;
 
     //update the component
-    children.at(idx)->update(*this);
+    child.update(*this);
 
-    //check if the component collided
-    if (check_child_collisions(idx)) {
-      //reset
-      children.at(idx)->bounds = old_position;
-    }
+    //update is effected by gravity
+    int gravity = (child.flags & COMPONENT_GRAVITY) ? GRAVITY_PER_TICK : 0;
 
-    //get the new old position
-    old_position = children.at(idx)->bounds;
+    if (child.flags & COMPONENT_COLLIDABLE) {
+      //one swept pass for the update and gravity
+      resolve_child_motion(child,old_position,gravity);
 
-    //update is effected by gravity
-    if (children.at(idx)->flags & COMPONENT_GRAVITY) {
-      //update y position
-      children.at(idx)->bounds.y += GRAVITY_PER_TICK;
-
-      //check collision
-      if (check_child_collisions(idx)) {
-        //reset
-        children.at(idx)->bounds = old_position;
-      }
+    } else if (gravity) {
+      child.bounds.y += gravity;
+      child.bounds_changed();
     }
+    child.snapped = false;
 
     //check whether this is the player
-    if (state::entity::player_t* player = dynamic_cast<state::entity::player_t*>(children.at(idx).get())) {
-      update_interactive_components(*player);
+    if ((child.kinds & COMPONENT_KIND_PLAYER) && interactions) {
+      update_interactive_components(static_cast<state::entity::player_t&>(child));
     }
   }
 
@@ -235,21 +530,30 @@ namespace common {
                                  const SDL_Event& e) {
     //pass to children
     for (size_t i=0; i<children.size(); i++) {
-      child_handle_event(e,i);
+      child_handle_event(e,*children[i]);
     }
   }
 
   /**
    * Let a single child handle the event
    * @param e   the event
-   * @param idx the child index
+   * @param idx the child id
    */
   void component_t::child_handle_event(const SDL_Event& e, size_t idx) {
-    children.at(idx)->handle_event(*this,e);
+    child_handle_event(e,child_at(idx));
+  }
+
+  /**
+   * Let a single child handle the event
+   * @param e     the event
+   * @param child the child
+   */
+  void component_t::child_handle_event(const SDL_Event& e, component_t& child) {
+    child.handle_event(*this,e);
 
     //check if this is the player
-    if (state::entity::player_t* player = dynamic_cast<state::entity::player_t*>(children.at(idx).get())) {
-      interactive_components_handle_event(e,*player);
+    if ((child.kinds & COMPONENT_KIND_PLAYER) && interactions) {
+      interactive_components_handle_event(e,static_cast<state::entity::player_t&>(child));
     }
   }
 
@@ -259,11 +563,35 @@ namespace common {
    * Implemented by the concrete type
    * @param renderer the sdl renderer
    * @param camera   the current camera
+   * @param alpha    progress (0-1) between the last tick and the next
    */
   void component_t::render(SDL_Renderer& renderer,
-                           const SDL_Rect& camera) const {
+                           const SDL_Rect& camera,
+                           float alpha) const {
+    if (children.size() < COMPONENT_BATCH_CULL_MIN) {
+      for (size_t i=0; i<children.size(); i++) {
+        render_child(renderer,camera,alpha,*children[i]);
+      }
+      return;
+    }
+
+    //test every child against the camera at once, only hits are asked is_visible
+    if (!render_cull) {
+      render_cull = std::make_unique<render_cull_t>();
+    }
+    render_cull->bounds.clear();
+    for (size_t i=0; i<children.size(); i++) {
+      render_cull->bounds.push_back(children[i]->bounds);
+    }
+    aabb_overlap_mask(camera, render_cull->bounds.data(), children.size(), render_cull->hits);
+
     for (size_t i=0; i<children.size(); i++) {
-      render_child(renderer,camera,i);
+      const component_t& child = *children[i];
+      if ((child.flags & COMPONENT_ALWAYS_VISIBLE) ||
+          (aabb_mask_test(render_cull->hits, i) && child.is_visible(camera))) {
+        render_layer_scope_t layer_scope(child.render_layer);
+        child.render(renderer,camera,alpha);
+      }
     }
   }
 
@@ -278,7 +606,7 @@ namespace common {
     //by default, only render interactive component children if player can interact
     if (!(this->flags & COMPONENT_INTERACTIVE) || this->can_interact) {
       for (size_t i=0; i<children.size(); i++) {
-        render_fg_child(renderer,camera,i);
+        children[i]->render_fg(renderer,camera);
       }
     }
   }
@@ -287,14 +615,31 @@ namespace common {
    * Render a single child
    * @param renderer the sdl renderer
    * @param camera   the camera
-   * @param idx      the child to render
+   * @param alpha    progress (0-1) between the last tick and the next
+   * @param idx      the id of the child to render
    */
   void component_t::render_child(SDL_Renderer& renderer,
                                  const SDL_Rect& camera,
+                                 float alpha,
                                  size_t idx) const {
-    if ((children.at(idx)->flags & COMPONENT_ALWAYS_VISIBLE) ||
-        children.at(idx)->is_visible(camera)) {
-      children.at(idx)->render(renderer,camera);
+    render_child(renderer,camera,alpha,child_at(idx));
+  }
+
+  /**
+   * Render a single child
+   * @param renderer the sdl renderer
+   * @param camera   the camera
+   * @param alpha    progress (0-1) between the last tick and the next
+   * @param child    the child to render
+   */
+  void component_t::render_child(SDL_Renderer& renderer,
+                                 const SDL_Rect& camera,
+                                 float alpha,
+                                 const component_t& child) const {
+    if ((child.flags & COMPONENT_ALWAYS_VISIBLE) ||
+        child.is_visible(camera)) {
+      render_layer_scope_t layer_scope(child.render_layer);
+      child.render(renderer,camera,alpha);
     }
   }
 
@@ -302,12 +647,14 @@ namespace common {
    * Render a single child fg components
    * @param renderer the sdl renderer
    * @param camera   the camera
-   * @param idx      the child to render
+   * @param idx      the id of the child to render
    */
   void component_t::render_fg_child(SDL_Renderer& renderer,
                                     const SDL_Rect& camera,
                                     size_t idx) const {
-    children.at(idx)->render_fg(renderer,camera);
+    //ui draws over every layer
+    render_layer_scope_t layer_scope(RENDER_LAYER_UI);
+    child_at(idx).render_fg(renderer,camera);
   }
 
   /**
@@ -318,7 +665,12 @@ namespace common {
   void component_t::load_children(SDL_Renderer& renderer,
                                   shared_resources& resources) {
     for (size_t i=0; i<children.size(); i++) {
-      children.at(i)->load(renderer, *this, resources);
+      children[i]->load(renderer, *this, resources);
+    }
+
+    //children are loaded, index anything interactive
+    if (interactions) {
+      register_interactive_children(*interactions);
     }
   }
 
@@ -333,23 +685,41 @@ namespace common {
     SDL_Rect render_bounds = {bounds.x - camera.x,
                               bounds.y - camera.y,
                               bounds.w, bounds.h};
+    //drawn immediately, over anything recorded so far
+    render_queue_t::submit_active();
     //set the draw color
     SDL_SetRenderDrawColor(&renderer,0,255,0,127);
     //render the bounds
     SDL_RenderDrawRect(&renderer,&render_bounds);
   }
 
+  /**
+   * Get the bounds interpolated between the last two updates
+   * @param  alpha progress (0-1) between the last tick and the next
+   * @return       the interpolated bounds
+   */
+  SDL_Rect component_t::get_interpolated_bounds(float alpha) const {
+    int dx = bounds.x - prev_bounds.x;
+    int dy = bounds.y - prev_bounds.y;
+
+    //don't smear large jumps (level switches, climbing snaps)
+    if ((std::abs(dx) > INTERPOLATION_SNAP_PX) ||
+        (std::abs(dy) > INTERPOLATION_SNAP_PX)) {
+      return bounds;
+    }
+
+    return {prev_bounds.x + (int)(dx * alpha),
+            prev_bounds.y + (int)(dy * alpha),
+            bounds.w, bounds.h};
+  }
+
   /**
    * Whether this component is currently visible to the camera
    * @return whether the component is visible
    * @param camera the current camera
    */
   bool component_t::is_visible(const SDL_Rect& camera) const {
-    return (flags & COMPONENT_VISIBLE) &&
-            ((bounds.x < (camera.x + camera.w)) &&
-            ((bounds.x + bounds.w) > camera.x) &&
-            (bounds.y < (camera.y + camera.h)) &&
-            ((bounds.y + bounds.h) > camera.y));
+    return (flags & COMPONENT_VISIBLE) && rect_visible(bounds, camera);
   }
 
   /**
@@ -358,11 +728,29 @@ namespace common {
    * @return       whether the two components collide
    */
   bool component_t::collides_with(const component_t& other) const {
-    return (flags & COMPONENT_COLLIDABLE) &&
-            ((bounds.x < (other.bounds.x + other.bounds.w)) &&
-            ((bounds.x + bounds.w) > other.bounds.x) &&
-            (bounds.y < (other.bounds.y + other.bounds.h)) &&
-            ((bounds.y + bounds.h) > other.bounds.y));
+    return (flags & COMPONENT_COLLIDABLE) && rect_overlaps(bounds, other.bounds);
+  }
+
+  /**
+   * Collect the rects that make this component solid within an area
+   * (the bounds by default, tiles for maps)
+   * @param area   the area to collect from
+   * @param solids the rects (appended)
+   */
+  void component_t::solid_rects(const SDL_Rect& area,
+                                std::vector<SDL_Rect>& solids) const {
+    if ((flags & COMPONENT_COLLIDABLE) && rect_overlaps(bounds, area)) {
+      solids.push_back(bounds);
+    }
+  }
+
+  /**
+   * Get the entity store for this part of the tree
+   * (by default the parent's, levels own one)
+   * @return the store (or nullptr)
+   */
+  std::shared_ptr<entity_store_t> component_t::get_entity_store() {
+    return parent ? parent->get_entity_store() : nullptr;
   }
 
   /**
@@ -372,9 +760,34 @@ namespace common {
    */
   component_t& component_t::set_position(int x, int y) {
     this->bounds = { x, y, bounds.w, bounds.h };
+    bounds_changed();
     return *this;
   }
 
+  /**
+   * Move to a position without sweeping the path there (for moves that
+   * step over geometry, i.e. climbing), the move is undone if the
+   * destination is solid
+   * @param x position x
+   * @param y position y
+   */
+  component_t& component_t::snap_position(int x, int y) {
+    snapped = true;
+    return set_position(x,y);
+  }
+
+  /**
+   * Apply motion resolved outside the tree (i.e. by the entity store's
+   * motion pass), adding any contacts it made
+   * @param sweep the resolved movement
+   */
+  void component_t::apply_motion(const sweep_result_t& sweep) {
+    contacts |= contact_flags(sweep);
+    if ((sweep.bounds.x != bounds.x) || (sweep.bounds.y != bounds.y)) {
+      set_position(sweep.bounds.x, sweep.bounds.y);
+    }
+  }
+
   /**
    * Set the width and height of the object
    * @param w the new width
@@ -382,6 +795,7 @@ namespace common {
    */
   component_t& component_t::set_size(int w, int h) {
     this->bounds = { bounds.x, bounds.y, w, h };
+    bounds_changed();
     return *this;
   }
 
@@ -400,16 +814,12 @@ namespace common {
    * @return whether this position is solid
    */
   bool component_t::solid_at(int x, int y) const {
-    if (is_solid() &&
-        (x > bounds.x) &&
-        (x < (bounds.x + bounds.w)) &&
-        (y > bounds.y) &&
-        (y < (bounds.y + bounds.h))) {
+    if (is_solid() && rect_interior_contains(bounds, x, y)) {
       return true;
     }
     //check children
     for (size_t i=0; i<children.size(); i++) {
-      if (children.at(i)->solid_at(x,y)) {
+      if (children[i]->solid_at(x,y)) {
         return true;
       }
     }
@@ -418,9 +828,15 @@ namespace common {
 
   /**
    * Mark this component for removal
+   * (removed at the end of the tick)
    */
   void component_t::mark_for_removal() {
     flags |= COMPONENT_REMOVE;
+
+    //flag the path down from the root so the removal pass can skip clean subtrees
+    for (component_t* c = parent; c && !c->removal_pending; c = c->parent) {
+      c->removal_pending = true;
+    }
   }
 
   /**
@@ -429,19 +845,6 @@ namespace common {
    * @return      the full path to load from
    */
   std::string component_t::rsrc_path(const std::string& path) const {
-#ifndef __APPLE__
-    std::filesystem::path dir(resource_dir_prefix);
-    std::filesystem::path rsrc(path);
-
-    std::filesystem::path full_path = dir / rsrc;
-
-    return full_path.string();
-#else
-    if ((resource_dir_prefix.size() > 0) &&
-        (resource_dir_prefix.back() == '/')) {
-      return resource_dir_prefix + path;
-    }
-    return resource_dir_prefix + "/" + path;
-#endif
+    return resource_root ? resource_root->resolve(path) : path;
   }
 }
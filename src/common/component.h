@@ -11,8 +11,17 @@
 #include <vector>
 #include <string>
 #include <stdint.h>
+#include <typeinfo>
+#include <type_traits>
+#include <stdexcept>
 #include <SDL2/SDL.h>
 #include "shared_resources.h"
+#include "spatial_hash.h"
+#include "interaction_index.h"
+#include "arena.h"
+#include "resource_root.h"
+#include "render_queue.h"
+#include "sweep.h"
 
 namespace state {
   namespace entity {
@@ -22,6 +31,8 @@ namespace state {
 
 namespace common {
 
+  class entity_store_t;
+
   //flags
   #define COMPONENT_COLLIDABLE     0x80 // a physical component in the map (can collide with solid components)
   #define COMPONENT_SOLID          0x40 // Other components cannot move through this one
@@ -32,32 +43,204 @@ namespace common {
   #define COMPONENT_INTERACTIVE    0x02 // this component can be interacted with (by the player)
   #define COMPONENT_AUTO_INTERACT  0x01 // interaction is triggered automatically
 
+  //kinds (capability tags checked instead of rtti)
+  #define COMPONENT_KIND_ANIM       0x0001 // common::anim_t
+  #define COMPONENT_KIND_ACTION     0x0002 // entity::actions::action_t
+  #define COMPONENT_KIND_ENTITY     0x0004 // entity::entity_t
+  #define COMPONENT_KIND_PLAYER     0x0008 // entity::player_t
+  #define COMPONENT_KIND_ATTRIBUTES 0x0010 // entity::entity_attributes_t
+  #define COMPONENT_KIND_LEVEL      0x0020 // levels::level_t
+  #define COMPONENT_KIND_MANAGER    0x0040 // level_manager_t
+  #define COMPONENT_KIND_TILEMAP    0x0080 // tilemap::tilemap_t
+  #define COMPONENT_KIND_LAYER      0x0100 // tilemap::layer_t
+
   #define GRAVITY_PER_TICK 2
 
+  //contacts found resolving the last tick's motion (get_contacts)
+  #define CONTACT_GROUND  0x01 // blocked moving down (standing on something)
+  #define CONTACT_CEILING 0x02 // blocked moving up
+  #define CONTACT_WALL    0x04 // blocked moving sideways
+  //moves larger than this (px per tick) are not interpolated (i.e. teleports)
+  #define INTERPOLATION_SNAP_PX 16
+
+  //space before each component allocation recording its arena (keeps max alignment)
+  #define COMPONENT_ALLOC_HEADER alignof(std::max_align_t)
+
+  //children needed before rendering culls them in one batch
+  #define COMPONENT_BATCH_CULL_MIN 16
+
+  //child ids are a slot in the low bits and the slot generation in the high bits
+  #define CHILD_ID_SLOT_BITS 32
+  #define CHILD_ID_SLOT_MASK 0xffffffffULL
+
+  /*
+   * Id of a child whose type is known when it is added
+   */
+  template <typename T>
+  struct child_handle_t {
+    size_t idx;
+  };
+
+  /*
+   * Where a child id currently lives in the children array
+   */
+  struct child_slot_t {
+    //index into the (compacted) children
+    uint32_t dense;
+    //bumped whenever the slot is freed so old ids go stale
+    uint32_t generation;
+  };
+
+  /*
+   * Packed child bounds and camera hits (reused between frames)
+   */
+  struct render_cull_t {
+    std::vector<SDL_Rect> bounds;
+    std::vector<uint64_t> hits;
+  };
+
   //Updatable, renderable component
   struct component_t {
   private:
     //the parent of this component
     component_t* parent;
-    //the children of this component
+    //the id of this component in the parent
+    size_t child_id;
+    //the children of this component (in insertion order, compacted on removal)
     std::vector<std::unique_ptr<component_t>> children;
+    //child id slots (ids stay valid when children are compacted)
+    std::vector<child_slot_t> slots;
+    //free slots to reuse
+    std::vector<uint32_t> free_slots;
+    //whether something in this subtree is marked for removal
+    bool removal_pending;
+    //broadphase for solid children (optional)
+    std::unique_ptr<spatial_hash_t> broadphase;
+    //index of interactive components in this subtree (optional)
+    std::unique_ptr<interaction_index_t> interactions;
+    //the index this component is registered in (if interactive)
+    interaction_index_t* interaction_owner;
+    //the id of this component in that index
+    size_t interaction_id;
     //the bounds and position of this component
     SDL_Rect bounds;
+    //the bounds at the start of the last update (for render interpolation)
+    SDL_Rect prev_bounds;
     //the flags for this component
     uint8_t flags;
+    //the kinds this component is (COMPONENT_KIND_*)
+    uint16_t kinds;
     //the interaction key
     SDL_Keycode interaction_key;
-    //directory to prefix paths to load resources from
-    std::string resource_dir_prefix;
+    //directory to load resources from (shared, inherited from the parent)
+    const resource_root_t* resource_root;
     //whether the player is within the interaction radius
     bool can_interact;
+    //the layer this subtree draws in (RENDER_LAYER_*)
+    uint8_t render_layer;
+    //batch culling scratch (only for components with many children)
+    mutable std::unique_ptr<render_cull_t> render_cull;
+    //solids gathered when resolving a child's motion (reused)
+    std::vector<SDL_Rect> motion_solids;
+    //CONTACT_* flags from resolving the last tick's motion
+    uint8_t contacts;
+    //whether this update's move was a snap (only the destination is checked)
+    bool snapped;
+
+    /**
+     * Get the slot of a child id
+     * @param  id the child id
+     * @return    the slot
+     */
+    static uint32_t id_slot(size_t id) { return (uint32_t)(id & CHILD_ID_SLOT_MASK); }
+
+    /**
+     * Get a child by id
+     * @param  id the child id
+     * @return    the child (throws std::out_of_range if the id is stale)
+     */
+    component_t& child_at(size_t id) const {
+      uint32_t slot = id_slot(id);
+      if ((slot >= slots.size()) ||
+          (slots[slot].generation != (uint32_t)(id >> CHILD_ID_SLOT_BITS))) {
+        throw std::out_of_range("stale child id");
+      }
+      return *children[slots[slot].dense];
+    }
+
+    /**
+     * Collect the solid rects of a child's siblings within an area
+     * @param child  the child (or nullptr for all children)
+     * @param area   the area to collect from
+     * @param solids the rects (appended)
+     */
+    void gather_child_solids(const component_t* child,
+                             const SDL_Rect& area,
+                             std::vector<SDL_Rect>& solids) const;
 
     /**
-     * Calculate collisions for a child
-     * @param idx the child to check
-     * @return whether the child collided with a solid component
+     * Resolve a child's movement for this tick against its solid siblings
+     * @param child        the child
+     * @param old_position the bounds before the update
+     * @param gravity      gravity to apply (px)
      */
-    bool check_child_collisions(size_t idx) const;
+    void resolve_child_motion(component_t& child,
+                              const SDL_Rect& old_position,
+                              int gravity);
+
+    /**
+     * Add a child to the broadphase (if it is solid)
+     * @param child the child
+     */
+    void broadphase_insert(const component_t& child);
+
+    /**
+     * Unregister this subtree from any interaction index
+     */
+    void release_interactions();
+
+    /**
+     * Update a single child
+     * @param child the child
+     */
+    void update_child(component_t& child);
+
+    /**
+     * Let a single child handle the event
+     * @param e     the event
+     * @param child the child
+     */
+    void child_handle_event(const SDL_Event& e, component_t& child);
+
+    /**
+     * Render a single child
+     * @param renderer the sdl renderer
+     * @param camera   the camera
+     * @param alpha    progress (0-1) between the last tick and the next
+     * @param child    the child to render
+     */
+    void render_child(SDL_Renderer& renderer,
+                      const SDL_Rect& camera,
+                      float alpha,
+                      const component_t& child) const;
+
+    /**
+     * Notify the parent broadphase that the bounds changed
+     */
+    void bounds_changed();
+
+    /**
+     * Register the interactive components below this one
+     * @param index the index to register with
+     */
+    void register_interactive_children(interaction_index_t& index);
+
+    /**
+     * Register a child and the interactive components below it
+     * @param index the index to register with
+     * @param child the child
+     */
+    void register_interactive_child(interaction_index_t& index, component_t& child);
 
     /**
      * Call update on an interactive components close enough to the provided location
@@ -77,10 +260,52 @@ namespace common {
     /**
      * Add a child to this component (assumes ownership)
      * @param c the child
-     * @return the index of the child
+     * @return the id of the child (stays valid until the child is removed)
      */
     size_t add_child(std::unique_ptr<component_t> c);
 
+    /**
+     * Add a child and keep its type (assumes ownership)
+     * @param c the child
+     * @return a handle to the child
+     */
+    template <typename T>
+    child_handle_t<T> add_child_as(std::unique_ptr<T> c) {
+      return { add_child(std::move(c)) };
+    }
+
+    /**
+     * Destroy all children now (i.e. before an arena they live in is released)
+     */
+    void clear_children();
+
+    /**
+     * Tag this component with a kind (set by constructors)
+     * @param kind the COMPONENT_KIND_* to add
+     */
+    void add_kind(uint16_t kind) { kinds |= kind; }
+
+    /**
+     * Clear flags (i.e. COMPONENT_GRAVITY once the entity store applies it)
+     * @param flags COMPONENT_* bits to clear
+     */
+    void remove_flags(uint8_t flags) { this->flags &= ~flags; }
+
+    /**
+     * Track solid children in a uniform grid so that collision
+     * checks only test siblings sharing a cell
+     * @param cell_dim the grid cell size (px)
+     */
+    void enable_broadphase(int cell_dim);
+
+    /**
+     * Index the interactive components in this subtree (when children
+     * are loaded, and as children are added after that) so that the
+     * player only checks nearby ones
+     * @param cell_dim the grid cell size (px)
+     */
+    void enable_interactions(int cell_dim);
+
     /**
      * Get the nth child, cast to type
      * @param  i index of the child
@@ -88,7 +313,13 @@ namespace common {
      */
     template <typename T>
     const T& get_nth_child(size_t i) const {
-      return dynamic_cast<const T&>(*this->children.at(i));
+      static_assert(std::is_same<typename T::component_kind_owner_t, T>::value,
+                    "type must declare its own component_kind");
+      const component_t& child = child_at(i);
+      if (!child.has_kind(T::component_kind)) {
+        throw std::bad_cast();
+      }
+      return static_cast<const T&>(child);
     }
 
     /**
@@ -98,7 +329,33 @@ namespace common {
      */
     template <typename T>
     T& get_nth_child(size_t i) {
-      return dynamic_cast<T&>(*this->children.at(i));
+      static_assert(std::is_same<typename T::component_kind_owner_t, T>::value,
+                    "type must declare its own component_kind");
+      component_t& child = child_at(i);
+      if (!child.has_kind(T::component_kind)) {
+        throw std::bad_cast();
+      }
+      return static_cast<T&>(child);
+    }
+
+    /**
+     * Get a child by handle (type checked when it was added)
+     * @param  h the child handle
+     * @return   the child
+     */
+    template <typename T>
+    const T& get_child(child_handle_t<T> h) const {
+      return static_cast<const T&>(child_at(h.idx));
+    }
+
+    /**
+     * Get a child by handle NON CONST
+     * @param  h the child handle
+     * @return   the child
+     */
+    template <typename T>
+    T& get_child(child_handle_t<T> h) {
+      return static_cast<T&>(child_at(h.idx));
     }
 
     /**
@@ -107,7 +364,7 @@ namespace common {
      * @return   the child
      */
     component_t& get_nth_child(size_t i) {
-      return *this->children.at(i);
+      return child_at(i);
     }
 
     /**
@@ -121,7 +378,7 @@ namespace common {
 
     /**
      * Update a single child
-     * @param idx the index of the child
+     * @param idx the id of the child
      */
     void update_child(size_t idx);
 
@@ -136,7 +393,7 @@ namespace common {
     /**
      * Let a single child handle the event
      * @param e   the event
-     * @param idx the child index
+     * @param idx the child id
      */
     void child_handle_event(const SDL_Event& e, size_t idx);
 
@@ -146,9 +403,11 @@ namespace common {
      * Implemented by the concrete type
      * @param renderer the sdl renderer
      * @param camera   the current camera
+     * @param alpha    progress (0-1) between the last tick and the next
      */
     virtual void render(SDL_Renderer& renderer,
-                        const SDL_Rect& camera) const;
+                        const SDL_Rect& camera,
+                        float alpha) const;
 
     /**
      * Render any foreground elements for this component (i.e. ui components)
@@ -163,17 +422,19 @@ namespace common {
      * Render a single child
      * @param renderer the sdl renderer
      * @param camera   the camera
-     * @param idx      the child to render
+     * @param alpha    progress (0-1) between the last tick and the next
+     * @param idx      the id of the child to render
      */
     void render_child(SDL_Renderer& renderer,
                       const SDL_Rect& camera,
+                      float alpha,
                       size_t idx) const;
 
     /**
      * Render a single child fg components
      * @param renderer the sdl renderer
      * @param camera   the camera
-     * @param idx      the child to render
+     * @param idx      the id of the child to render
      */
     void render_fg_child(SDL_Renderer& renderer,
                          const SDL_Rect& camera,
@@ -187,6 +448,13 @@ namespace common {
     void load_children(SDL_Renderer& renderer,
                        shared_resources& resources);
 
+    /**
+     * Remove children marked for removal anywhere in this subtree
+     * (compacts each affected child list in one pass, ids of the
+     * remaining children stay valid)
+     */
+    void remove_marked_children();
+
     /**
      * Load any resources for this component
      * @param renderer the sdl renderer for loading images
@@ -222,17 +490,22 @@ namespace common {
                                 state::entity::player_t& player) {}
 
   public:
+    //kind tag checked by get_nth_child/get_as (any component matches), types
+    //cast to must declare their own tag and owner (inherited tags would match a sibling)
+    static const uint16_t component_kind = 0;
+    typedef component_t component_kind_owner_t;
+
     /**
      * Constructor
      * @param bounds the bounds of the component
      * @param flags  attributes
      * @param interaction_key the key to trigger player interaction (if applicable)
-     * @param resource_dir_prefix a prefix to add to resource load paths
+     * @param resource_root the directory to load resources from (see resource_root_t::intern)
      */
     component_t(SDL_Rect&& bounds,
                 uint8_t flags,
                 SDL_Keycode interaction_key=SDLK_e,
-                const std::string& resource_dir_prefix="");
+                const resource_root_t* resource_root=nullptr);
 
     /**
      * Copy constructor
@@ -250,6 +523,19 @@ namespace common {
     //no default construction
     component_t() = delete;
 
+    /**
+     * Allocate a component (from the active arena if there is one)
+     * @param  size the size of the component
+     * @return      the memory
+     */
+    static void* operator new(size_t size);
+
+    /**
+     * Free a component (no-op for arena memory, freed with the arena)
+     * @param p the component memory
+     */
+    static void operator delete(void* p);
+
     //Virtual destructor
     virtual ~component_t();
 
@@ -260,17 +546,40 @@ namespace common {
      */
     bool get_parent(component_t** parent);
 
+    /**
+     * Get this component as a concrete type
+     * @return a reference to this (throws exception if cast fails)
+     */
     template <typename T>
     T& get_as() {
-      return dynamic_cast<T&>(*this);
+      static_assert(std::is_same<typename T::component_kind_owner_t, T>::value,
+                    "type must declare its own component_kind");
+      if (!has_kind(T::component_kind)) {
+        throw std::bad_cast();
+      }
+      return static_cast<T&>(*this);
     }
 
+    /**
+     * Whether this component is tagged with all of the given kinds
+     * @param  kind COMPONENT_KIND_* bits
+     * @return      whether the kinds match
+     */
+    bool has_kind(uint16_t kind) const { return (kinds & kind) == kind; }
+
     /**
      * Get the bounds of the component
      * @return the component bounds
      */
     const SDL_Rect& get_bounds() const { return bounds; }
 
+    /**
+     * Get the bounds interpolated between the last two updates
+     * @param  alpha progress (0-1) between the last tick and the next
+     * @return       the interpolated bounds
+     */
+    SDL_Rect get_interpolated_bounds(float alpha) const;
+
     /**
      * Whether this component is currently visible to the camera
      * @return whether the component is visible
@@ -285,6 +594,15 @@ namespace common {
      */
     component_t& set_position(int x, int y);
 
+    /**
+     * Move to a position without sweeping the path there (for moves that
+     * step over geometry, i.e. climbing), the move is undone if the
+     * destination is solid
+     * @param x position x
+     * @param y position y
+     */
+    component_t& snap_position(int x, int y);
+
     /**
      * Set the width and height of the object
      * @param w the new width
@@ -292,8 +610,28 @@ namespace common {
      */
     component_t& set_size(int w, int h);
 
+    /**
+     * Get the contacts found resolving the last tick's motion
+     * @return CONTACT_* flags
+     */
+    uint8_t get_contacts() const { return contacts; }
+
+    /**
+     * Apply motion resolved outside the tree (i.e. by the entity store's
+     * motion pass), adding any contacts it made
+     * @param sweep the resolved movement
+     */
+    void apply_motion(const sweep_result_t& sweep);
+
+    /**
+     * Set the layer this component and its children draw in
+     * @param layer RENDER_LAYER_* (RENDER_LAYER_INHERIT to use the parent's)
+     */
+    void set_render_layer(uint8_t layer) { render_layer = layer; }
+
     /**
      * Mark this component for removal
+     * (removed at the end of the tick)
      */
     void mark_for_removal();
 
@@ -311,12 +649,44 @@ namespace common {
      */
     virtual bool collides_with(const component_t& other) const;
 
+    /**
+     * Collect the rects that make this component solid within an area
+     * (the bounds by default, tiles for maps)
+     * @param area   the area to collect from
+     * @param solids the rects (appended)
+     */
+    virtual void solid_rects(const SDL_Rect& area,
+                             std::vector<SDL_Rect>& solids) const;
+
+    /**
+     * Collect the solid rects of all children within an area
+     * @param area   the area to collect from
+     * @param solids the rects (appended)
+     */
+    void collect_child_solids(const SDL_Rect& area,
+                              std::vector<SDL_Rect>& solids) const {
+      gather_child_solids(nullptr,area,solids);
+    }
+
+    /**
+     * Get the entity store for this part of the tree
+     * (by default the parent's, levels own one)
+     * @return the store (or nullptr)
+     */
+    virtual std::shared_ptr<entity_store_t> get_entity_store();
+
     /**
      * Whether the component is collidable
      * @return whether the component is collidable
      */
     virtual bool is_solid() const;
 
+    /**
+     * Whether the component can collide with solid components
+     * @return whether the collidable flag is set
+     */
+    bool is_collidable() const { return flags & COMPONENT_COLLIDABLE; }
+
     /**
      * Check if this component is solid at some position
      * @param x position x
@@ -0,0 +1,221 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "entity_store.h"
+#include "component.h"
+#include "sweep.h"
+#include "aabb_batch.h"
+#include <algorithm>
+
+namespace common {
+
+  /**
+   * Constructor
+   */
+  entity_store_t::entity_store_t()
+    : slot_dense(),
+      slot_generation(),
+      free_slots(),
+      dense_slot(),
+      bounds(),
+      motion_owner(),
+      velocity_x(),
+      velocity_y(),
+      flags(),
+      visible(),
+      anim_frames(),
+      anim_frame(),
+      anim_delay(),
+      anim_counter(),
+      anim_once(),
+      anim_active(),
+      solids(),
+      cull_mask() {}
+
+  /**
+   * Add an entry
+   * @param  bounds the starting bounds
+   * @param  flags  COMPONENT_* flags
+   * @return        the handle to the entry
+   */
+  entity_handle_t entity_store_t::add(const SDL_Rect& bounds, uint8_t flags) {
+    uint32_t slot;
+    if (!free_slots.empty()) {
+      slot = free_slots.back();
+      free_slots.pop_back();
+    } else {
+      slot = (uint32_t)slot_dense.size();
+      slot_dense.push_back(0);
+      slot_generation.push_back(0);
+    }
+    slot_dense[slot] = (uint32_t)this->bounds.size();
+    dense_slot.push_back(slot);
+
+    this->bounds.push_back(bounds);
+    motion_owner.push_back(nullptr);
+    velocity_x.push_back(0);
+    velocity_y.push_back(0);
+    this->flags.push_back(flags);
+    //visible until the first cull
+    visible.push_back(1);
+
+    anim_frames.push_back(0);
+    anim_frame.push_back(0);
+    anim_delay.push_back(0);
+    anim_counter.push_back(0);
+    anim_once.push_back(0);
+    anim_active.push_back(0);
+
+    return {slot, slot_generation[slot]};
+  }
+
+  /**
+   * Remove an entry (swaps the last entry into its place)
+   * @param h the handle (ignored if stale)
+   */
+  void entity_store_t::remove(entity_handle_t h) {
+    if (!valid(h)) {
+      return;
+    }
+    uint32_t idx = slot_dense[h.slot];
+    uint32_t last = (uint32_t)bounds.size() - 1;
+
+    //move the last entry into the hole
+    if (idx != last) {
+      bounds[idx] = bounds[last];
+      motion_owner[idx] = motion_owner[last];
+      velocity_x[idx] = velocity_x[last];
+      velocity_y[idx] = velocity_y[last];
+      flags[idx] = flags[last];
+      visible[idx] = visible[last];
+      anim_frames[idx] = anim_frames[last];
+      anim_frame[idx] = anim_frame[last];
+      anim_delay[idx] = anim_delay[last];
+      anim_counter[idx] = anim_counter[last];
+      anim_once[idx] = anim_once[last];
+      anim_active[idx] = anim_active[last];
+      dense_slot[idx] = dense_slot[last];
+      slot_dense[dense_slot[idx]] = idx;
+    }
+
+    bounds.pop_back();
+    motion_owner.pop_back();
+    velocity_x.pop_back();
+    velocity_y.pop_back();
+    flags.pop_back();
+    visible.pop_back();
+    anim_frames.pop_back();
+    anim_frame.pop_back();
+    anim_delay.pop_back();
+    anim_counter.pop_back();
+    anim_once.pop_back();
+    anim_active.pop_back();
+    dense_slot.pop_back();
+
+    //retire the handle
+    slot_generation[h.slot]++;
+    free_slots.push_back(h.slot);
+  }
+
+  /**
+   * Give an entry animation state
+   * @param h      the handle
+   * @param frames the number of frames
+   * @param delay  ticks between frames
+   * @param once   play once and hold the last frame until reset
+   */
+  void entity_store_t::set_animation(entity_handle_t h, int frames, int delay, bool once) {
+    uint32_t idx = dense(h);
+    anim_frames[idx] = (int16_t)frames;
+    anim_frame[idx] = 0;
+    anim_delay[idx] = (int16_t)delay;
+    anim_counter[idx] = (int16_t)delay;
+    anim_once[idx] = once;
+    anim_active[idx] = 0;
+  }
+
+  /**
+   * System: move entries by their velocity plus gravity (for
+   * COMPONENT_GRAVITY), collidable entries are swept against
+   * the solid children of the world
+   * @param world the component whose children are solid (i.e. the level)
+   */
+  void entity_store_t::step_motion(const component_t& world) {
+    for (size_t i=0; i<bounds.size(); i++) {
+      int dx = velocity_x[i];
+      int dy = velocity_y[i] + ((flags[i] & COMPONENT_GRAVITY) ? GRAVITY_PER_TICK : 0);
+      if (!dx && !dy) {
+        continue;
+      }
+
+      //pick up anything the owner's update did this tick
+      if (motion_owner[i]) {
+        bounds[i] = motion_owner[i]->get_bounds();
+      }
+
+      SDL_Rect& b = bounds[i];
+      if (!(flags[i] & COMPONENT_COLLIDABLE)) {
+        b.x += dx;
+        b.y += dy;
+        if (motion_owner[i]) {
+          motion_owner[i]->apply_motion({b, 1.0f, 0, 0});
+        }
+        continue;
+      }
+
+      //everything reachable this tick (+1px for contact probes)
+      SDL_Rect area = {std::min(b.x, b.x + dx) - 1,
+                       std::min(b.y, b.y + dy) - 1,
+                       b.w + std::abs(dx) + 2,
+                       b.h + std::abs(dy) + 2};
+      solids.clear();
+      world.collect_child_solids(area,solids);
+      sweep_result_t moved = sweep_move(b,dx,dy,solids);
+      b = moved.bounds;
+      if (motion_owner[i]) {
+        motion_owner[i]->apply_motion(moved);
+      }
+    }
+  }
+
+  /**
+   * System: advance animations marked active this tick
+   */
+  void entity_store_t::advance_animations() {
+    for (size_t i=0; i<anim_frames.size(); i++) {
+      if (!anim_active[i] || !anim_frames[i]) {
+        continue;
+      }
+      anim_active[i] = 0;
+
+      //update if not single cycle or not on final frame or not at full delay
+      bool last_frame = anim_frame[i] >= (anim_frames[i] - 1);
+      if (!anim_once[i] || !last_frame || (anim_counter[i] > 0)) {
+        anim_counter[i]--;
+
+        //check if frame update needed
+        if ((anim_counter[i] <= 0) && (!anim_once[i] || !last_frame)) {
+          anim_counter[i] = anim_delay[i];
+          anim_frame[i] = (anim_frame[i] + 1) % anim_frames[i];
+        }
+      }
+    }
+  }
+
+  /**
+   * System: mark the entries the camera can see
+   * @param camera the camera (include any interpolation margin)
+   */
+  void entity_store_t::cull(const SDL_Rect& camera) {
+    //test every entry against the camera at once, then apply the flags
+    aabb_overlap_mask(camera, bounds.data(), bounds.size(), cull_mask);
+    for (size_t i=0; i<bounds.size(); i++) {
+      visible[i] = (flags[i] & COMPONENT_ALWAYS_VISIBLE) ||
+                   ((flags[i] & COMPONENT_VISIBLE) && aabb_mask_test(cull_mask, i));
+    }
+  }
+
+}
@@ -0,0 +1,236 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_ENTITY_STORE_H
+#define _DIVEBAR_COMMON_ENTITY_STORE_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <stdint.h>
+
+namespace common {
+
+  struct component_t;
+
+  /*
+   * Stable reference to an entry in the entity store
+   */
+  struct entity_handle_t {
+    uint32_t slot;
+    uint32_t generation;
+  };
+
+  /*
+   * Per level entity data kept as structure of arrays so that
+   * systems (motion, animation, culling) run as linear passes.
+   * Components move their state here a piece at a time and keep
+   * a handle (see anim_t for animation, entity_t for gravity)
+   */
+  class entity_store_t {
+  private:
+    //per slot: dense index and generation
+    std::vector<uint32_t> slot_dense;
+    std::vector<uint32_t> slot_generation;
+    std::vector<uint32_t> free_slots;
+    //per dense entry: owning slot (for swap removal)
+    std::vector<uint32_t> dense_slot;
+
+    //bounds and motion
+    std::vector<SDL_Rect> bounds;
+    //the component whose bounds the motion pass reads and writes (optional)
+    std::vector<component_t*> motion_owner;
+    std::vector<int16_t> velocity_x;
+    std::vector<int16_t> velocity_y;
+    //COMPONENT_* flags
+    std::vector<uint8_t> flags;
+    //culling result (1 if the camera can see the entry)
+    std::vector<uint8_t> visible;
+
+    //animation state (frames == 0 for no animation)
+    std::vector<int16_t> anim_frames;
+    std::vector<int16_t> anim_frame;
+    std::vector<int16_t> anim_delay;
+    std::vector<int16_t> anim_counter;
+    std::vector<uint8_t> anim_once;
+    //whether the animation was updated this tick (only those advance)
+    std::vector<uint8_t> anim_active;
+
+    //solids gathered by the motion system (reused)
+    std::vector<SDL_Rect> solids;
+    //camera hits from the culling system (reused)
+    std::vector<uint64_t> cull_mask;
+
+    /**
+     * Get the dense index for a handle (handle must be valid)
+     * @param  h the handle
+     * @return   the dense index
+     */
+    uint32_t dense(entity_handle_t h) const { return slot_dense[h.slot]; }
+
+  public:
+    /**
+     * Constructor
+     */
+    entity_store_t();
+    entity_store_t(const entity_store_t&) = delete;
+    entity_store_t& operator=(const entity_store_t&) = delete;
+
+    /**
+     * Add an entry
+     * @param  bounds the starting bounds
+     * @param  flags  COMPONENT_* flags
+     * @return        the handle to the entry
+     */
+    entity_handle_t add(const SDL_Rect& bounds, uint8_t flags);
+
+    /**
+     * Remove an entry (swaps the last entry into its place)
+     * @param h the handle (ignored if stale)
+     */
+    void remove(entity_handle_t h);
+
+    /**
+     * Whether a handle refers to a live entry
+     * @param  h the handle
+     * @return   whether the handle is valid
+     */
+    bool valid(entity_handle_t h) const {
+      return (h.slot < slot_generation.size()) &&
+             (slot_generation[h.slot] == h.generation);
+    }
+
+    /**
+     * Number of live entries
+     * @return the entry count
+     */
+    size_t size() const { return bounds.size(); }
+
+    /**
+     * Get the bounds of an entry
+     * @param  h the handle
+     * @return   the bounds
+     */
+    const SDL_Rect& get_bounds(entity_handle_t h) const { return bounds[dense(h)]; }
+
+    /**
+     * Set the bounds of an entry
+     * @param h the handle
+     * @param b the bounds
+     */
+    void set_bounds(entity_handle_t h, const SDL_Rect& b) { bounds[dense(h)] = b; }
+
+    /**
+     * Set the velocity of an entry
+     * @param h  the handle
+     * @param vx px per tick x
+     * @param vy px per tick y
+     */
+    void set_velocity(entity_handle_t h, int vx, int vy) {
+      velocity_x[dense(h)] = (int16_t)vx;
+      velocity_y[dense(h)] = (int16_t)vy;
+    }
+
+    /**
+     * Have the motion pass move a component (its bounds are read before
+     * moving and the result is applied with component_t::apply_motion)
+     * @param h     the handle
+     * @param owner the component (nullptr to stop)
+     */
+    void set_motion_owner(entity_handle_t h, component_t* owner) { motion_owner[dense(h)] = owner; }
+
+    /**
+     * Get the flags of an entry
+     * @param  h the handle
+     * @return   COMPONENT_* flags
+     */
+    uint8_t get_flags(entity_handle_t h) const { return flags[dense(h)]; }
+
+    /**
+     * Set the flags of an entry
+     * @param h the handle
+     * @param f COMPONENT_* flags
+     */
+    void set_flags(entity_handle_t h, uint8_t f) { flags[dense(h)] = f; }
+
+    /**
+     * Whether the last cull pass found the entry visible
+     * @param  h the handle
+     * @return   whether the entry is visible
+     */
+    bool is_visible(entity_handle_t h) const { return visible[dense(h)]; }
+
+    /**
+     * Give an entry animation state
+     * @param h      the handle
+     * @param frames the number of frames
+     * @param delay  ticks between frames
+     * @param once   play once and hold the last frame until reset
+     */
+    void set_animation(entity_handle_t h, int frames, int delay, bool once);
+
+    /**
+     * Get the current animation frame
+     * @param  h the handle
+     * @return   the frame
+     */
+    int get_anim_frame(entity_handle_t h) const { return anim_frame[dense(h)]; }
+
+    /**
+     * Get the ticks left on the current animation frame
+     * @param  h the handle
+     * @return   the frame delay counter
+     */
+    int get_anim_counter(entity_handle_t h) const { return anim_counter[dense(h)]; }
+
+    /**
+     * Restart an animation
+     * @param h the handle
+     */
+    void reset_animation(entity_handle_t h) {
+      anim_counter[dense(h)] = anim_delay[dense(h)];
+      anim_frame[dense(h)] = 0;
+    }
+
+    /**
+     * Overwrite the animation progress
+     * @param h       the handle
+     * @param frame   the current frame
+     * @param counter ticks left on the frame
+     */
+    void set_anim_state(entity_handle_t h, int frame, int counter) {
+      anim_frame[dense(h)] = (int16_t)frame;
+      anim_counter[dense(h)] = (int16_t)counter;
+    }
+
+    /**
+     * Advance this animation in the next animation pass
+     * @param h the handle
+     */
+    void mark_anim_active(entity_handle_t h) { anim_active[dense(h)] = 1; }
+
+    /**
+     * System: move entries by their velocity plus gravity (for
+     * COMPONENT_GRAVITY), collidable entries are swept against
+     * the solid children of the world
+     * @param world the component whose children are solid (i.e. the level)
+     */
+    void step_motion(const component_t& world);
+
+    /**
+     * System: advance animations marked active this tick
+     */
+    void advance_animations();
+
+    /**
+     * System: mark the entries the camera can see
+     * @param camera the camera (include any interpolation margin)
+     */
+    void cull(const SDL_Rect& camera);
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_ENTITY_STORE_H*/
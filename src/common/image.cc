@@ -6,6 +6,10 @@
 
 #include "image.h"
 #include "launch_exception.h"
+#include "asset_loader.h"
+#include "texture_atlas.h"
+#include "sprite_batch.h"
+#include "render_queue.h"
 
 namespace common {
 
@@ -14,7 +18,10 @@ namespace common {
    * @param renderer the sdl renderer
    * @param path path to the resource
    */
-  image_t::image_t(SDL_Renderer& renderer, const std::string& path) {
+  image_t::image_t(SDL_Renderer& renderer, const std::string& path)
+    : origin{0,0},
+      page(),
+      pending() {
     SDL_Surface* surface = IMG_Load(path.c_str());
     if (surface == NULL) {
       //failed to load
@@ -47,28 +54,51 @@ namespace common {
    */
   image_t::image_t(SDL_Texture *texture, unsigned int w, unsigned int h)
     : texture(texture),
-      default_sample_bounds{0,0,(int)w,(int)h} {}
+      default_sample_bounds{0,0,(int)w,(int)h},
+      origin{0,0},
+      page(),
+      pending() {}
+
+  /**
+   * Construct from a background load (see asset_loader_t)
+   * @param request the load (the texture is taken when it is ready)
+   */
+  image_t::image_t(std::shared_ptr<image_request_t> request)
+    : texture(NULL),
+      default_sample_bounds{0,0,0,0},
+      origin{0,0},
+      page(),
+      pending(request) {}
 
   /**
    * Copy constructor
    * @param other [description]
    */
   image_t::image_t(const image_t& other)
-    : texture(other.texture),
-      default_sample_bounds(other.default_sample_bounds) {}
+    : texture(other.get_texture()),
+      default_sample_bounds(other.default_bounds()),
+      origin(other.origin),
+      page(other.page),
+      pending() {}
 
   /**
    * Assignment operator
    */
   image_t& image_t::operator=(const image_t& other) {
-    this->texture = other.texture;
-    this->default_sample_bounds = other.default_sample_bounds;
+    this->texture = other.get_texture();
+    this->default_sample_bounds = other.default_bounds();
+    this->origin = other.origin;
+    this->page = other.page;
+    this->pending.reset();
     return *this;
   }
 
   //free the resource
   image_t::~image_t() {
-    SDL_DestroyTexture(this->texture);
+    //atlas pages are freed with their last image
+    if (!page) {
+      SDL_DestroyTexture(this->texture);
+    }
   }
 
   /**
@@ -76,9 +106,29 @@ namespace common {
    * @return sample bounds
    */
   const SDL_Rect& image_t::default_bounds() const {
+    if (pending) {
+      resolve();
+    }
     return default_sample_bounds;
   }
 
+  /**
+   * Whether the texture can be used without waiting
+   * @return whether the image is loaded
+   */
+  bool image_t::is_loaded() const {
+    return !pending || pending->is_uploaded();
+  }
+
+  /**
+   * Finish a background load (waits for decoding if needed)
+   */
+  void image_t::resolve() const {
+    pending->upload();
+    this->texture = pending->take_texture(this->default_sample_bounds, this->origin, this->page);
+    pending.reset();
+  }
+
   /**
    * Render the image at some position
    * @param renderer      the sdl renderer
@@ -90,17 +140,35 @@ namespace common {
                             const SDL_Rect& sample_bounds,
                             const SDL_Rect& render_bounds,
                             bool flipped) const {
+    //first draw of a background load
+    if (pending) {
+      resolve();
+    }
+
+    //the image may be part of a larger texture
+    SDL_Rect texture_bounds = {sample_bounds.x + origin.x,
+                               sample_bounds.y + origin.y,
+                               sample_bounds.w, sample_bounds.h};
+
+    //recorded for the frame, drawn sorted and batched on submit
+    render_queue_t* queue = render_queue_t::current();
+    if (queue != nullptr) {
+      queue->push(this->texture, texture_bounds, render_bounds, flipped);
+      return;
+    }
+
+    sprite_batch_t::count_draw_call();
     if (flipped) {
       SDL_RenderCopyEx(&renderer,
                        this->texture,
-                       &sample_bounds,
+                       &texture_bounds,
                        &render_bounds,
                        0, NULL,
                        SDL_FLIP_HORIZONTAL);
     } else {
       SDL_RenderCopy(&renderer,
                      this->texture,
-                     &sample_bounds,
+                     &texture_bounds,
                      &render_bounds);
     }
   }
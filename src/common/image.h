@@ -10,15 +10,30 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <string>
+#include <memory>
 
 namespace common {
 
+  class image_request_t;
+  class atlas_page_t;
+
   class image_t {
   private:
-    //the texture
-    SDL_Texture* texture = NULL;
+    //the texture (created on first use for background loads)
+    mutable SDL_Texture* texture = NULL;
     //the default sample bounds
-    SDL_Rect default_sample_bounds;
+    mutable SDL_Rect default_sample_bounds;
+    //where the image starts in the texture (non zero for atlas pages)
+    mutable SDL_Point origin;
+    //the atlas page the texture belongs to (nullptr if the image owns the texture)
+    mutable std::shared_ptr<atlas_page_t> page;
+    //the background load this image is waiting on (if any)
+    mutable std::shared_ptr<image_request_t> pending;
+
+    /**
+     * Finish a background load (waits for decoding if needed)
+     */
+    void resolve() const;
 
   public:
     /**
@@ -41,6 +56,12 @@ namespace common {
      */
     image_t(SDL_Texture *texture, unsigned int w, unsigned int h);
 
+    /**
+     * Construct from a background load (see asset_loader_t)
+     * @param request the load (the texture is taken when it is ready)
+     */
+    explicit image_t(std::shared_ptr<image_request_t> request);
+
     image_t(const image_t& other);
     image_t& operator=(const image_t& other);
 
@@ -53,6 +74,46 @@ namespace common {
      */
     const SDL_Rect& default_bounds() const;
 
+    /**
+     * Get the underlying texture (owned by the image or its atlas,
+     * the image is at get_origin within it)
+     * @return the texture
+     */
+    SDL_Texture* get_texture() const {
+      if (pending) {
+        resolve();
+      }
+      return texture;
+    }
+
+    /**
+     * Get the atlas page holding the image
+     * @return the page (nullptr if the image has a texture of its own)
+     */
+    const std::shared_ptr<atlas_page_t>& get_page() const {
+      if (pending) {
+        resolve();
+      }
+      return page;
+    }
+
+    /**
+     * Get where the image starts in its texture
+     * @return the offset of the image
+     */
+    const SDL_Point& get_origin() const {
+      if (pending) {
+        resolve();
+      }
+      return origin;
+    }
+
+    /**
+     * Whether the texture can be used without waiting
+     * @return whether the image is loaded
+     */
+    bool is_loaded() const;
+
     /**
      * Render the image at some position
      * @param renderer      the sdl renderer
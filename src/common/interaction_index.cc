@@ -0,0 +1,105 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "interaction_index.h"
+#include "component.h"
+#include "aabb_batch.h"
+#include <algorithm>
+
+namespace common {
+
+  /**
+   * Constructor
+   * @param cell_dim the grid cell size (px)
+   */
+  interaction_index_t::interaction_index_t(int cell_dim)
+    : entries(),
+      bounds(),
+      grid(cell_dim),
+      in_range(),
+      prev_in_range(),
+      candidate_bounds(),
+      candidate_hits(),
+      overlaps() {}
+
+  /**
+   * Register an interactive component
+   * @param component the component
+   * @param parent    the parent of the component
+   * @param in_range  whether the player can currently interact with it
+   * @return          the id of the component in the index
+   */
+  size_t interaction_index_t::add(component_t& component, component_t& parent, bool in_range) {
+    size_t id = entries.size();
+    entries.push_back({&component, &parent, in_range});
+    bounds.push_back(component.get_bounds());
+    grid.insert(id, component.get_bounds());
+    if (in_range) {
+      this->in_range.push_back(id);
+    }
+    return id;
+  }
+
+  /**
+   * Unregister a component
+   * @param id the component id
+   */
+  void interaction_index_t::remove(size_t id) {
+    grid.remove(id);
+    entries[id].component = nullptr;
+    entries[id].parent = nullptr;
+    entries[id].near = false;
+    in_range.erase(std::remove(in_range.begin(), in_range.end(), id), in_range.end());
+  }
+
+  /**
+   * Update the position of a registered component
+   * @param id     the component id
+   * @param bounds the new bounds
+   */
+  void interaction_index_t::moved(size_t id, const SDL_Rect& bounds) {
+    this->bounds[id] = bounds;
+    grid.update(id, bounds);
+  }
+
+  /**
+   * Start an update, the current in range set becomes the previous one
+   * @return the components that were in range (cleared on the next update)
+   */
+  const std::vector<size_t>& interaction_index_t::begin_update() {
+    prev_in_range.swap(in_range);
+    in_range.clear();
+    for (size_t id : prev_in_range) {
+      entries[id].near = false;
+    }
+    return prev_in_range;
+  }
+
+  /**
+   * Get the components overlapping some bounds
+   * (result is valid until the next query)
+   * @param  area the bounds to check
+   * @return      the ids of the overlapping components
+   */
+  const std::vector<size_t>& interaction_index_t::overlapping(const SDL_Rect& area) {
+    //pack the grid candidates and test them in one batch
+    const std::vector<size_t>& candidates = grid.query(area);
+    candidate_bounds.clear();
+    for (size_t id : candidates) {
+      candidate_bounds.push_back(bounds[id]);
+    }
+    aabb_overlap_mask(area, candidate_bounds.data(), candidate_bounds.size(), candidate_hits);
+
+    overlaps.clear();
+    for (size_t i=0; i<candidates.size(); i++) {
+      if (aabb_mask_test(candidate_hits, i)) {
+        overlaps.push_back(candidates[i]);
+      }
+    }
+    return overlaps;
+  }
+
+}
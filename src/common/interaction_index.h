@@ -0,0 +1,140 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_INTERACTION_INDEX_H
+#define _DIVEBAR_COMMON_INTERACTION_INDEX_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "spatial_hash.h"
+
+namespace common {
+
+  struct component_t;
+
+  /*
+   * The interactive components in a subtree (registered as they are added and at load),
+   * looked up by proximity to the player
+   */
+  class interaction_index_t {
+  private:
+    struct entry_t {
+      //the interactive component
+      component_t* component;
+      //its parent (passed to the interaction callbacks)
+      component_t* parent;
+      //whether the player overlaps it as of the current update
+      bool near;
+    };
+
+    //registered components (by id)
+    std::vector<entry_t> entries;
+    //the bounds of each component (by id, kept by moved)
+    std::vector<SDL_Rect> bounds;
+    //the components by position
+    spatial_hash_t grid;
+    //components the player can interact with
+    std::vector<size_t> in_range;
+    //components the player could interact with before the current update
+    std::vector<size_t> prev_in_range;
+    //scratch for overlap queries (reused)
+    std::vector<SDL_Rect> candidate_bounds;
+    std::vector<uint64_t> candidate_hits;
+    std::vector<size_t> overlaps;
+
+  public:
+    /**
+     * Constructor
+     * @param cell_dim the grid cell size (px)
+     */
+    interaction_index_t(int cell_dim);
+    interaction_index_t(const interaction_index_t&) = delete;
+    interaction_index_t& operator=(const interaction_index_t&) = delete;
+
+    /**
+     * Register an interactive component
+     * @param component the component
+     * @param parent    the parent of the component
+     * @param in_range  whether the player can currently interact with it
+     * @return          the id of the component in the index
+     */
+    size_t add(component_t& component, component_t& parent, bool in_range);
+
+    /**
+     * Unregister a component
+     * @param id the component id
+     */
+    void remove(size_t id);
+
+    /**
+     * Update the position of a registered component
+     * @param id     the component id
+     * @param bounds the new bounds
+     */
+    void moved(size_t id, const SDL_Rect& bounds);
+
+    /**
+     * Start an update, the current in range set becomes the previous one
+     * @return the components that were in range (cleared on the next update)
+     */
+    const std::vector<size_t>& begin_update();
+
+    /**
+     * Get the components near some bounds
+     * (result is valid until the next query)
+     * @param  bounds the bounds
+     * @return        the candidate ids
+     */
+    const std::vector<size_t>& nearby(const SDL_Rect& bounds) const {
+      return grid.query(bounds);
+    }
+
+    /**
+     * Get the components overlapping some bounds
+     * (result is valid until the next query)
+     * @param  area the bounds to check
+     * @return      the ids of the overlapping components
+     */
+    const std::vector<size_t>& overlapping(const SDL_Rect& area);
+
+    /**
+     * Get the components the player can interact with
+     * @return the in range ids
+     */
+    std::vector<size_t>& get_in_range() { return in_range; }
+
+    /**
+     * Get a registered component
+     * @param  id the component id
+     * @return    the component
+     */
+    component_t& get_component(size_t id) const { return *entries[id].component; }
+
+    /**
+     * Get the parent of a registered component
+     * @param  id the component id
+     * @return    the parent
+     */
+    component_t& get_parent(size_t id) const { return *entries[id].parent; }
+
+    /**
+     * Whether a component was marked near in the current update
+     * @param  id the component id
+     * @return    whether it is near
+     */
+    bool is_near(size_t id) const { return entries[id].near; }
+
+    /**
+     * Mark a component near/not near for the current update
+     * @param id   the component id
+     * @param near whether the component is near
+     */
+    void set_near(size_t id, bool near) { entries[id].near = near; }
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_INTERACTION_INDEX_H*/
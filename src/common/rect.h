@@ -0,0 +1,149 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_RECT_H
+#define _DIVEBAR_COMMON_RECT_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+
+/*
+ * Axis aligned rect math on plain SDL_Rects (half open: [x, x + w))
+ * used for collision, culling and grid lookups without building components
+ */
+namespace common {
+
+  /*
+   * An inclusive range of grid cells
+   */
+  struct cell_range_t {
+    int col_start, col_end;
+    int row_start, row_end;
+
+    /**
+     * Whether the range covers no cells
+     * @return whether the range is empty
+     */
+    bool empty() const { return (col_start > col_end) || (row_start > row_end); }
+  };
+
+  /**
+   * Floor division (cells for negative positions)
+   * @param  a numerator
+   * @param  b denominator (positive)
+   * @return   floor(a / b)
+   */
+  inline int floor_div(int a, int b) {
+    return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+  }
+
+  /**
+   * Whether a rect has no area
+   * @param  r the rect
+   * @return   whether the rect is empty
+   */
+  inline bool rect_empty(const SDL_Rect& r) {
+    return (r.w <= 0) || (r.h <= 0);
+  }
+
+  /**
+   * Whether two rects overlap (touching edges don't)
+   * @param  a the first rect
+   * @param  b the second rect
+   * @return   whether the two overlap
+   */
+  inline bool rect_overlaps(const SDL_Rect& a, const SDL_Rect& b) {
+    return (a.x < (b.x + b.w)) &&
+           ((a.x + a.w) > b.x) &&
+           (a.y < (b.y + b.h)) &&
+           ((a.y + a.h) > b.y);
+  }
+
+  /**
+   * Whether a rect lies entirely within another
+   * @param  outer the containing rect
+   * @param  inner the contained rect
+   * @return       whether inner is inside outer
+   */
+  inline bool rect_contains(const SDL_Rect& outer, const SDL_Rect& inner) {
+    return (inner.x >= outer.x) &&
+           (inner.y >= outer.y) &&
+           ((inner.x + inner.w) <= (outer.x + outer.w)) &&
+           ((inner.y + inner.h) <= (outer.y + outer.h));
+  }
+
+  /**
+   * Whether a point is strictly inside a rect (not on an edge)
+   * @param  r the rect
+   * @param  x position x
+   * @param  y position y
+   * @return   whether the point is inside
+   */
+  inline bool rect_interior_contains(const SDL_Rect& r, int x, int y) {
+    return (x > r.x) && (x < (r.x + r.w)) &&
+           (y > r.y) && (y < (r.y + r.h));
+  }
+
+  /**
+   * Whether a rect can be seen by a camera
+   * @param  r      the rect (world coordinates)
+   * @param  camera the camera
+   * @return        whether the rect is in view
+   */
+  inline bool rect_visible(const SDL_Rect& r, const SDL_Rect& camera) {
+    return rect_overlaps(r,camera);
+  }
+
+  /**
+   * The smallest rect covering two rects
+   * @param  a the first rect
+   * @param  b the second rect
+   * @return   the union
+   */
+  inline SDL_Rect rect_union(const SDL_Rect& a, const SDL_Rect& b) {
+    int x0 = std::min(a.x, b.x);
+    int y0 = std::min(a.y, b.y);
+    int x1 = std::max(a.x + a.w, b.x + b.w);
+    int y1 = std::max(a.y + a.h, b.y + b.h);
+    return {x0, y0, x1 - x0, y1 - y0};
+  }
+
+  /**
+   * Grow a rect on every side
+   * @param  r      the rect
+   * @param  margin the amount to grow by (px)
+   * @return        the grown rect
+   */
+  inline SDL_Rect rect_expand(const SDL_Rect& r, int margin) {
+    return {r.x - margin, r.y - margin, r.w + (2 * margin), r.h + (2 * margin)};
+  }
+
+  /**
+   * Get the grid cells a rect covers
+   * @param  r        the rect
+   * @param  cell_dim the size of a cell (px)
+   * @return          the covered cells (empty if the rect is)
+   */
+  inline cell_range_t rect_cells(const SDL_Rect& r, int cell_dim) {
+    return {floor_div(r.x, cell_dim), floor_div(r.x + r.w - 1, cell_dim),
+            floor_div(r.y, cell_dim), floor_div(r.y + r.h - 1, cell_dim)};
+  }
+
+  /**
+   * Clamp a range of cells to a grid
+   * @param  range the range
+   * @param  cols  the width of the grid (cells)
+   * @param  rows  the height of the grid (cells)
+   * @return       the clamped range (may be empty)
+   */
+  inline cell_range_t clamp_cells(const cell_range_t& range, int cols, int rows) {
+    return {std::max(range.col_start, 0), std::min(range.col_end, cols - 1),
+            std::max(range.row_start, 0), std::min(range.row_end, rows - 1)};
+  }
+
+}
+
+#endif /*_DIVEBAR_COMMON_RECT_H*/
@@ -0,0 +1,152 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "render_queue.h"
+#include "sprite_batch.h"
+#include <array>
+#include <utility>
+
+namespace common {
+
+  render_queue_t* render_queue_t::active = nullptr;
+
+  /**
+   * Stable LSD radix sort on the key, one byte per pass
+   * (passes where every key has the same byte are skipped)
+   * @param keys    the keys to sort (sorted on return)
+   * @param scratch buffer to sort through
+   */
+  static void radix_sort(std::vector<render_key_t>& keys, std::vector<render_key_t>& scratch) {
+    size_t n = keys.size();
+    scratch.resize(n);
+
+    for (int shift=0; shift<64; shift+=8) {
+      std::array<size_t, 256> counts = {};
+      for (size_t i=0; i<n; i++) {
+        counts[(keys[i].key >> shift) & 0xFF]++;
+      }
+      //nothing to reorder on this byte
+      if (counts[(keys[0].key >> shift) & 0xFF] == n) {
+        continue;
+      }
+
+      //bucket starts
+      size_t offset = 0;
+      for (size_t& count : counts) {
+        size_t bucket = count;
+        count = offset;
+        offset += bucket;
+      }
+      for (size_t i=0; i<n; i++) {
+        scratch[counts[(keys[i].key >> shift) & 0xFF]++] = keys[i];
+      }
+      keys.swap(scratch);
+    }
+  }
+
+  /**
+   * Constructor, the queue is active until destroyed
+   * @param renderer the renderer to draw with
+   */
+  render_queue_t::render_queue_t(SDL_Renderer& renderer)
+    : renderer(&renderer),
+      commands(),
+      keys(),
+      sorted(),
+      textures(),
+      layer(RENDER_LAYER_ENTITY),
+      prev(active) {
+    active = this;
+  }
+
+  /**
+   * Destructor, submits anything recorded and restores the previous queue
+   */
+  render_queue_t::~render_queue_t() {
+    submit();
+    active = prev;
+  }
+
+  /**
+   * Get the key of a texture
+   * @param  texture the texture
+   * @return         the key (first use order this frame)
+   */
+  uint32_t render_queue_t::texture_key(SDL_Texture* texture) {
+    //few textures per frame (atlas pages and map chunks), most recent first
+    for (size_t i=textures.size(); i>0; i--) {
+      if (textures[i - 1] == texture) {
+        return (uint32_t)(i - 1);
+      }
+    }
+    textures.push_back(texture);
+    return (uint32_t)(textures.size() - 1);
+  }
+
+  /**
+   * Record a sprite in the current layer
+   * @param texture the texture to sample
+   * @param sample  the region of the texture to sample
+   * @param dest    the region to draw to
+   * @param flipped whether to flip horizontally
+   */
+  void render_queue_t::push(SDL_Texture* texture,
+                            const SDL_Rect& sample,
+                            const SDL_Rect& dest,
+                            bool flipped) {
+    //layer (8 bits), texture (24 bits), bottom edge (32 bits, biased to sort signed)
+    uint64_t key = ((uint64_t)layer << 56) |
+                   ((uint64_t)(texture_key(texture) & 0xFFFFFF) << 32) |
+                   (uint64_t)((uint32_t)(dest.y + dest.h) ^ 0x80000000u);
+
+    keys.push_back({key, (uint32_t)commands.size()});
+    commands.push_back({texture, sample, dest, flipped});
+  }
+
+  /**
+   * Sort and draw the recorded commands
+   */
+  void render_queue_t::submit() {
+    if (commands.empty()) {
+      return;
+    }
+
+    radix_sort(keys, sorted);
+
+    //runs sharing a texture become one draw call
+    sprite_batch_t batch(*renderer);
+    for (const render_key_t& key : keys) {
+      const render_command_t& command = commands[key.command];
+      batch.add(command.texture, command.sample, command.dest, command.flipped);
+    }
+    batch.flush();
+
+    commands.clear();
+    keys.clear();
+    textures.clear();
+  }
+
+  /**
+   * Set the layer commands are recorded in
+   * @param  layer the layer
+   * @return       the previous layer
+   */
+  uint8_t render_queue_t::set_layer(uint8_t layer) {
+    std::swap(this->layer, layer);
+    return layer;
+  }
+
+  /**
+   * Draw anything recorded in the active queue (call before drawing
+   * outside the queue)
+   */
+  void render_queue_t::submit_active() {
+    if (active) {
+      active->submit();
+    }
+  }
+
+}
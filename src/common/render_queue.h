@@ -0,0 +1,156 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_RENDER_QUEUE_H
+#define _DIVEBAR_COMMON_RENDER_QUEUE_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <vector>
+
+namespace common {
+
+  //render layers (z), drawn lowest first
+  #define RENDER_LAYER_BG      0 // background map layers
+  #define RENDER_LAYER_ENTITY  1 // everything not given a layer
+  #define RENDER_LAYER_FG      2 // foreground map layers
+  #define RENDER_LAYER_UI      3 // prompts and overlays (render_fg)
+  #define RENDER_LAYER_INHERIT 0xFF // use the layer of the parent
+
+  /*
+   * A sprite to draw
+   */
+  struct render_command_t {
+    SDL_Texture* texture;
+    SDL_Rect sample;
+    SDL_Rect dest;
+    bool flipped;
+  };
+
+  /*
+   * Sort key of a command (layer, texture, y) and the command it belongs to
+   */
+  struct render_key_t {
+    uint64_t key;
+    uint32_t command;
+  };
+
+  /*
+   * Per frame command buffer. While active, image_t::render_copy records
+   * commands instead of drawing. On submit the commands are radix sorted
+   * by (layer, texture, bottom edge) and drawn as sprite batches, so draw
+   * order no longer depends on the order of the component tree.
+   * Ties keep the order commands were recorded in
+   */
+  class render_queue_t {
+  private:
+    //the renderer to draw with
+    SDL_Renderer* renderer;
+    //the commands recorded this frame
+    std::vector<render_command_t> commands;
+    //sort keys and radix sort scratch (reused between frames)
+    std::vector<render_key_t> keys;
+    std::vector<render_key_t> sorted;
+    //textures seen this frame, a texture's key is its position (first use order)
+    std::vector<SDL_Texture*> textures;
+    //the layer commands are recorded in
+    uint8_t layer;
+    //the queue active before this one
+    render_queue_t* prev;
+
+    //the queue image_t records into (if any)
+    static render_queue_t* active;
+
+    /**
+     * Get the key of a texture
+     * @param  texture the texture
+     * @return         the key (first use order this frame)
+     */
+    uint32_t texture_key(SDL_Texture* texture);
+
+  public:
+    /**
+     * Constructor, the queue is active until destroyed
+     * @param renderer the renderer to draw with
+     */
+    explicit render_queue_t(SDL_Renderer& renderer);
+    render_queue_t(const render_queue_t&) = delete;
+    render_queue_t& operator=(const render_queue_t&) = delete;
+
+    /**
+     * Destructor, submits anything recorded and restores the previous queue
+     */
+    ~render_queue_t();
+
+    /**
+     * Record a sprite in the current layer
+     * @param texture the texture to sample
+     * @param sample  the region of the texture to sample
+     * @param dest    the region to draw to
+     * @param flipped whether to flip horizontally
+     */
+    void push(SDL_Texture* texture,
+              const SDL_Rect& sample,
+              const SDL_Rect& dest,
+              bool flipped);
+
+    /**
+     * Sort and draw the recorded commands
+     */
+    void submit();
+
+    /**
+     * Set the layer commands are recorded in
+     * @param  layer the layer
+     * @return       the previous layer
+     */
+    uint8_t set_layer(uint8_t layer);
+
+    /**
+     * Get the active queue
+     * @return the queue (or nullptr)
+     */
+    static render_queue_t* current() { return active; }
+
+    /**
+     * Draw anything recorded in the active queue (call before drawing
+     * outside the queue)
+     */
+    static void submit_active();
+  };
+
+  /*
+   * Records into a layer of the active queue until the scope exits
+   */
+  class render_layer_scope_t {
+  private:
+    //the queue (nullptr if nothing changed)
+    render_queue_t* queue;
+    //the layer to restore
+    uint8_t prev;
+
+  public:
+    /**
+     * Constructor
+     * @param layer the layer (RENDER_LAYER_INHERIT keeps the current one)
+     */
+    explicit render_layer_scope_t(uint8_t layer)
+      : queue(layer == RENDER_LAYER_INHERIT ? nullptr : render_queue_t::current()),
+        prev(queue ? queue->set_layer(layer) : layer) {}
+    render_layer_scope_t(const render_layer_scope_t&) = delete;
+    render_layer_scope_t& operator=(const render_layer_scope_t&) = delete;
+
+    //restore the previous layer
+    ~render_layer_scope_t() {
+      if (queue) {
+        queue->set_layer(prev);
+      }
+    }
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_RENDER_QUEUE_H*/
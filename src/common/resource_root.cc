@@ -0,0 +1,69 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "resource_root.h"
+#ifndef __APPLE__
+#include <filesystem>
+#endif
+#include <memory>
+#include <vector>
+
+namespace common {
+
+  /**
+   * Constructor
+   * @param dir the resource directory
+   */
+  resource_root_t::resource_root_t(const std::string& dir)
+    : prefix() {
+#ifndef __APPLE__
+    //appending an empty element adds the platform separator (if missing)
+    prefix = (std::filesystem::path(dir) / "").string();
+#else
+    prefix = dir;
+    if ((prefix.size() > 0) && (prefix.back() != '/')) {
+      prefix += '/';
+    }
+#endif
+  }
+
+  /**
+   * Get the shared root for a directory (created on first use, never freed)
+   * @param  dir the resource directory
+   * @return     the interned root
+   */
+  const resource_root_t* resource_root_t::intern(const std::string& dir) {
+    //there are only ever a handful of roots, a linear scan is fine
+    static std::vector<std::unique_ptr<resource_root_t>> roots;
+
+    std::unique_ptr<resource_root_t> root(new resource_root_t(dir));
+    for (const std::unique_ptr<resource_root_t>& existing : roots) {
+      if (existing->prefix == root->prefix) {
+        return existing.get();
+      }
+    }
+    roots.push_back(std::move(root));
+    return roots.back().get();
+  }
+
+  /**
+   * Get the full path to a resource
+   * @param  path the path relative to the root
+   * @return      the full path to load from
+   */
+  std::string resource_root_t::resolve(const std::string& path) const {
+    //absolute paths are left alone (as with path concatenation)
+    if (prefix.empty() || (!path.empty() && (path[0] == '/'))) {
+      return path;
+    }
+
+    std::string full;
+    full.reserve(prefix.size() + path.size());
+    full += prefix;
+    full += path;
+    return full;
+  }
+}
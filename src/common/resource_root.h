@@ -0,0 +1,56 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_RESOURCE_ROOT_H
+#define _DIVEBAR_COMMON_RESOURCE_ROOT_H
+
+#include <string>
+
+namespace common {
+
+  /*
+   * An interned resource directory, shared by every component
+   * loaded from it (compare by pointer)
+   */
+  class resource_root_t {
+  private:
+    //the directory with a trailing separator (empty for the working directory)
+    std::string prefix;
+
+    /**
+     * Constructor
+     * @param dir the resource directory
+     */
+    explicit resource_root_t(const std::string& dir);
+
+  public:
+    resource_root_t(const resource_root_t&) = delete;
+    resource_root_t& operator=(const resource_root_t&) = delete;
+
+    /**
+     * Get the shared root for a directory (created on first use, never freed)
+     * @param  dir the resource directory
+     * @return     the interned root
+     */
+    static const resource_root_t* intern(const std::string& dir);
+
+    /**
+     * Get the full path to a resource
+     * @param  path the path relative to the root
+     * @return      the full path to load from
+     */
+    std::string resolve(const std::string& path) const;
+
+    /**
+     * Get the normalized directory
+     * @return the directory with a trailing separator
+     */
+    const std::string& get_prefix() const { return prefix; }
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_RESOURCE_ROOT_H*/
@@ -5,6 +5,7 @@
  */
 
 #include "shared_resources.h"
+#include "resource_root.h"
 
 namespace common {
 
@@ -12,10 +13,14 @@ namespace common {
    * Default constructor
    * @param renderer the sdl renderer for loading images
    * @param resource_dir the base resource directory
+   * @param textures the cache to load images through
    */
-  shared_resources::shared_resources(SDL_Renderer& renderer, const std::string& resource_dir)
-    : key_image(std::make_shared<image_t>(renderer, resource_dir + "tilesets/keys.png")),
-      player_image(std::make_shared<image_t>(renderer, resource_dir + "animations/player.png")),
-      divebar_tileset(std::make_shared<image_t>(renderer, resource_dir + "tilesets/bar.png")),
-      exterior_tileset(std::make_shared<image_t>(renderer, resource_dir + "tilesets/exterior.png")) {}
+  shared_resources::shared_resources(SDL_Renderer& renderer,
+                                     const std::string& resource_dir,
+                                     std::shared_ptr<texture_cache_t> textures)
+    : textures(textures),
+      key_image(textures->get(renderer, resource_root_t::intern(resource_dir)->resolve("tilesets/keys.png"))),
+      player_image(textures->get(renderer, resource_root_t::intern(resource_dir)->resolve("animations/player.png"))),
+      divebar_tileset(textures->get(renderer, resource_root_t::intern(resource_dir)->resolve("tilesets/bar.png"))),
+      exterior_tileset(textures->get(renderer, resource_root_t::intern(resource_dir)->resolve("tilesets/exterior.png"))) {}
 }
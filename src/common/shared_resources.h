@@ -9,8 +9,16 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <SDL2/SDL.h>
 #include "image.h"
+#include "texture_cache.h"
+
+namespace state {
+  namespace tilemap {
+    class map_document_t;
+  }
+}
 
 namespace common {
 
@@ -20,18 +28,27 @@ namespace common {
    */
   struct shared_resources {
   public:
+    //shared images by path, loaded in the background (use instead of constructing image_t)
+    std::shared_ptr<texture_cache_t> textures;
+
     //resources that can be accessed by other components
     std::shared_ptr<image_t> key_image;
     std::shared_ptr<image_t> player_image;
     std::shared_ptr<image_t> divebar_tileset;
     std::shared_ptr<image_t> exterior_tileset;
 
+    //parsed map files by path (see map_document_t::get)
+    std::unordered_map<std::string, std::shared_ptr<state::tilemap::map_document_t>> map_documents;
+
     /**
      * Default constructor
      * @param renderer the sdl renderer for loading images
      * @param resource_dir the base resource directory
+     * @param textures the cache to load images through
      */
-    shared_resources(SDL_Renderer& renderer, const std::string& resource_dir);
+    shared_resources(SDL_Renderer& renderer,
+                     const std::string& resource_dir,
+                     std::shared_ptr<texture_cache_t> textures);
     shared_resources(const shared_resources&) = delete;
     shared_resources& operator=(const shared_resources&) = delete;
   };
@@ -0,0 +1,183 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "spatial_hash.h"
+#include "rect.h"
+#include <algorithm>
+
+namespace common {
+
+  /**
+   * Constructor
+   * @param cell_dim the size of a cell (px)
+   */
+  spatial_hash_t::spatial_hash_t(int cell_dim)
+    : cell_dim(cell_dim),
+      entries(),
+      cells(),
+      unbounded(),
+      results(),
+      stamps(),
+      query_stamp(0) {}
+
+  /**
+   * Compute the cell range for some bounds
+   * @param bounds the bounds
+   * @param entry  the entry to update
+   */
+  void spatial_hash_t::cell_range(const SDL_Rect& bounds, entry_t& entry) const {
+    //zero sized bounds still occupy the cell they sit in
+    SDL_Rect occupied = {bounds.x, bounds.y, std::max(bounds.w, 1), std::max(bounds.h, 1)};
+    cell_range_t range = rect_cells(occupied, cell_dim);
+    entry.x0 = range.col_start;
+    entry.y0 = range.row_start;
+    entry.x1 = range.col_end;
+    entry.y1 = range.row_end;
+  }
+
+  /**
+   * Add an item to the cells in its range
+   * @param idx the item index
+   */
+  void spatial_hash_t::link(size_t idx) {
+    const entry_t& entry = entries[idx];
+    for (int cy=entry.y0; cy<=entry.y1; cy++) {
+      for (int cx=entry.x0; cx<=entry.x1; cx++) {
+        cells[cell_key(cx,cy)].push_back(idx);
+      }
+    }
+  }
+
+  /**
+   * Remove an item from the cells in its range
+   * @param idx the item index
+   */
+  void spatial_hash_t::unlink(size_t idx) {
+    const entry_t& entry = entries[idx];
+    for (int cy=entry.y0; cy<=entry.y1; cy++) {
+      for (int cx=entry.x0; cx<=entry.x1; cx++) {
+        auto cell = cells.find(cell_key(cx,cy));
+        if (cell != cells.end()) {
+          std::vector<size_t>& items = cell->second;
+          auto it = std::find(items.begin(), items.end(), idx);
+          if (it != items.end()) {
+            //order within a cell doesn't matter
+            *it = items.back();
+            items.pop_back();
+          }
+          if (items.empty()) {
+            cells.erase(cell);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Add an item
+   * @param idx    the item index
+   * @param bounds the item bounds
+   */
+  void spatial_hash_t::insert(size_t idx, const SDL_Rect& bounds) {
+    if (idx >= entries.size()) {
+      entries.resize(idx + 1, {false,false,0,0,0,0});
+      stamps.resize(idx + 1, 0);
+    }
+    remove(idx);
+
+    entry_t& entry = entries[idx];
+    entry.present = true;
+    entry.unbounded = (bounds.w <= 0) || (bounds.h <= 0);
+
+    if (entry.unbounded) {
+      unbounded.push_back(idx);
+    } else {
+      cell_range(bounds,entry);
+      link(idx);
+    }
+  }
+
+  /**
+   * Update the bounds of an item (no-op if not present)
+   * @param idx    the item index
+   * @param bounds the new bounds
+   */
+  void spatial_hash_t::update(size_t idx, const SDL_Rect& bounds) {
+    if (!contains(idx)) {
+      return;
+    }
+    entry_t& entry = entries[idx];
+
+    if (entry.unbounded || (bounds.w <= 0) || (bounds.h <= 0)) {
+      //switching between bounded and unbounded
+      insert(idx,bounds);
+      return;
+    }
+
+    entry_t moved = entry;
+    cell_range(bounds,moved);
+
+    //only touch the grid when the covered cells change
+    if ((moved.x0 != entry.x0) || (moved.y0 != entry.y0) ||
+        (moved.x1 != entry.x1) || (moved.y1 != entry.y1)) {
+      unlink(idx);
+      entry = moved;
+      link(idx);
+    }
+  }
+
+  /**
+   * Remove an item
+   * @param idx the item index
+   */
+  void spatial_hash_t::remove(size_t idx) {
+    if (!contains(idx)) {
+      return;
+    }
+    entry_t& entry = entries[idx];
+
+    if (entry.unbounded) {
+      unbounded.erase(std::find(unbounded.begin(), unbounded.end(), idx));
+    } else {
+      unlink(idx);
+    }
+    entry.present = false;
+  }
+
+  /**
+   * Get the items sharing a cell with some bounds
+   * (result is valid until the next query)
+   * @param  bounds the bounds to check
+   * @return        the candidate indices
+   */
+  const std::vector<size_t>& spatial_hash_t::query(const SDL_Rect& bounds) const {
+    results.assign(unbounded.begin(), unbounded.end());
+
+    //new stamp for deduping
+    if (++query_stamp == 0) {
+      std::fill(stamps.begin(), stamps.end(), 0);
+      query_stamp = 1;
+    }
+
+    entry_t range;
+    cell_range(bounds,range);
+
+    for (int cy=range.y0; cy<=range.y1; cy++) {
+      for (int cx=range.x0; cx<=range.x1; cx++) {
+        auto cell = cells.find(cell_key(cx,cy));
+        if (cell != cells.end()) {
+          for (size_t idx : cell->second) {
+            if (stamps[idx] != query_stamp) {
+              stamps[idx] = query_stamp;
+              results.push_back(idx);
+            }
+          }
+        }
+      }
+    }
+    return results;
+  }
+}
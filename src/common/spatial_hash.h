@@ -0,0 +1,127 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_SPATIAL_HASH_H
+#define _DIVEBAR_COMMON_SPATIAL_HASH_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace common {
+
+  /*
+   * Uniform grid broadphase keyed by child index
+   * Items with empty bounds (i.e. tilemaps) are treated as
+   * unbounded and returned by every query
+   */
+  class spatial_hash_t {
+  private:
+    //an item in the grid
+    struct entry_t {
+      bool present;
+      bool unbounded;
+      //the range of cells covered (inclusive)
+      int x0, y0, x1, y1;
+    };
+
+    //the size of a cell (px)
+    int cell_dim;
+    //items by index
+    std::vector<entry_t> entries;
+    //item indices by cell
+    std::unordered_map<uint64_t, std::vector<size_t>> cells;
+    //items that are always candidates
+    std::vector<size_t> unbounded;
+
+    //query results (reused between queries)
+    mutable std::vector<size_t> results;
+    //the last query each item was returned by
+    mutable std::vector<uint32_t> stamps;
+    //the current query (dedupes items spanning cells)
+    mutable uint32_t query_stamp;
+
+    /**
+     * Get the key for a cell
+     * @param  cx cell x
+     * @param  cy cell y
+     * @return    the key
+     */
+    static uint64_t cell_key(int cx, int cy) {
+      //shifted unsigned (negative cells are common left of and above the origin)
+      return ((uint64_t)(uint32_t)cx << 32) | (uint64_t)(uint32_t)cy;
+    }
+
+    /**
+     * Compute the cell range for some bounds
+     * @param bounds the bounds
+     * @param entry  the entry to update
+     */
+    void cell_range(const SDL_Rect& bounds, entry_t& entry) const;
+
+    /**
+     * Add an item to the cells in its range
+     * @param idx the item index
+     */
+    void link(size_t idx);
+
+    /**
+     * Remove an item from the cells in its range
+     * @param idx the item index
+     */
+    void unlink(size_t idx);
+
+  public:
+    /**
+     * Constructor
+     * @param cell_dim the size of a cell (px)
+     */
+    spatial_hash_t(int cell_dim);
+    spatial_hash_t(const spatial_hash_t&) = delete;
+    spatial_hash_t& operator=(const spatial_hash_t&) = delete;
+
+    /**
+     * Add an item
+     * @param idx    the item index
+     * @param bounds the item bounds
+     */
+    void insert(size_t idx, const SDL_Rect& bounds);
+
+    /**
+     * Update the bounds of an item (no-op if not present)
+     * @param idx    the item index
+     * @param bounds the new bounds
+     */
+    void update(size_t idx, const SDL_Rect& bounds);
+
+    /**
+     * Remove an item
+     * @param idx the item index
+     */
+    void remove(size_t idx);
+
+    /**
+     * Whether an item is in the grid
+     * @param  idx the item index
+     * @return     whether the item is present
+     */
+    bool contains(size_t idx) const {
+      return (idx < entries.size()) && entries[idx].present;
+    }
+
+    /**
+     * Get the items sharing a cell with some bounds
+     * (result is valid until the next query)
+     * @param  bounds the bounds to check
+     * @return        the candidate indices
+     */
+    const std::vector<size_t>& query(const SDL_Rect& bounds) const;
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_SPATIAL_HASH_H*/
@@ -0,0 +1,108 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "sprite_batch.h"
+#include <utility>
+
+namespace common {
+
+  uint32_t sprite_batch_t::draw_calls = 0;
+
+  /**
+   * Constructor
+   * @param renderer the renderer to draw with
+   */
+  sprite_batch_t::sprite_batch_t(SDL_Renderer& renderer)
+    : renderer(&renderer),
+      texture(NULL),
+      texture_w(1),
+      texture_h(1),
+      vertices(),
+      indices() {}
+
+  /**
+   * Destructor, draws anything waiting
+   */
+  sprite_batch_t::~sprite_batch_t() {
+    flush();
+  }
+
+  /**
+   * Add a quad
+   * @param texture the texture to sample
+   * @param sample  the region of the texture to sample
+   * @param dest    the region to draw to
+   * @param flipped whether to flip horizontally
+   */
+  void sprite_batch_t::add(SDL_Texture* texture,
+                           const SDL_Rect& sample,
+                           const SDL_Rect& dest,
+                           bool flipped) {
+    //a new texture ends the current run
+    if (texture != this->texture) {
+      flush();
+      this->texture = texture;
+      int w = 1;
+      int h = 1;
+      SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+      texture_w = (float)w;
+      texture_h = (float)h;
+    }
+
+    float u0 = sample.x / texture_w;
+    float u1 = (sample.x + sample.w) / texture_w;
+    float v0 = sample.y / texture_h;
+    float v1 = (sample.y + sample.h) / texture_h;
+    //flipping swaps the horizontal texture coordinates
+    if (flipped) {
+      std::swap(u0, u1);
+    }
+
+    float x0 = (float)dest.x;
+    float x1 = (float)(dest.x + dest.w);
+    float y0 = (float)dest.y;
+    float y1 = (float)(dest.y + dest.h);
+    const SDL_Color white = {0xFF,0xFF,0xFF,0xFF};
+
+    int base = (int)vertices.size();
+    vertices.push_back({{x0,y0}, white, {u0,v0}});
+    vertices.push_back({{x1,y0}, white, {u1,v0}});
+    vertices.push_back({{x1,y1}, white, {u1,v1}});
+    vertices.push_back({{x0,y1}, white, {u0,v1}});
+
+    //two triangles
+    const int quad[] = {0, 1, 2, 0, 2, 3};
+    for (int corner : quad) {
+      indices.push_back(base + corner);
+    }
+  }
+
+  /**
+   * Draw the quads waiting in this batch
+   */
+  void sprite_batch_t::flush() {
+    if (vertices.empty()) {
+      return;
+    }
+    SDL_RenderGeometry(renderer, texture,
+                       vertices.data(), (int)vertices.size(),
+                       indices.data(), (int)indices.size());
+    draw_calls++;
+    vertices.clear();
+    indices.clear();
+  }
+
+  /**
+   * Get the draw calls made since the last call (once per frame)
+   * @return the number of draw calls
+   */
+  uint32_t sprite_batch_t::take_draw_calls() {
+    uint32_t calls = draw_calls;
+    draw_calls = 0;
+    return calls;
+  }
+
+}
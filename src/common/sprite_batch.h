@@ -0,0 +1,81 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_SPRITE_BATCH_H
+#define _DIVEBAR_COMMON_SPRITE_BATCH_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <vector>
+
+namespace common {
+
+  /*
+   * Collects textured quads and draws each run of quads sharing a texture
+   * with one SDL_RenderGeometry call (draw order is kept, so atlas pages
+   * turn most of a frame into a few calls). Fed by render_queue_t
+   */
+  class sprite_batch_t {
+  private:
+    //the renderer to draw with
+    SDL_Renderer* renderer;
+    //the texture of the quads waiting to be drawn
+    SDL_Texture* texture;
+    //the size of that texture (for texture coordinates)
+    float texture_w, texture_h;
+    //the quads waiting to be drawn
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    //draw calls made since the count was last taken
+    static uint32_t draw_calls;
+
+  public:
+    /**
+     * Constructor
+     * @param renderer the renderer to draw with
+     */
+    explicit sprite_batch_t(SDL_Renderer& renderer);
+    sprite_batch_t(const sprite_batch_t&) = delete;
+    sprite_batch_t& operator=(const sprite_batch_t&) = delete;
+
+    /**
+     * Destructor, draws anything waiting
+     */
+    ~sprite_batch_t();
+
+    /**
+     * Add a quad
+     * @param texture the texture to sample
+     * @param sample  the region of the texture to sample
+     * @param dest    the region to draw to
+     * @param flipped whether to flip horizontally
+     */
+    void add(SDL_Texture* texture,
+             const SDL_Rect& sample,
+             const SDL_Rect& dest,
+             bool flipped);
+
+    /**
+     * Draw the quads waiting in this batch
+     */
+    void flush();
+
+    /**
+     * Count a draw call made outside a batch
+     */
+    static void count_draw_call() { draw_calls++; }
+
+    /**
+     * Get the draw calls made since the last call (once per frame)
+     * @return the number of draw calls
+     */
+    static uint32_t take_draw_calls();
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_SPRITE_BATCH_H*/
@@ -0,0 +1,259 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "sweep.h"
+#include "aabb_batch.h"
+#include "rect.h"
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+
+namespace common {
+
+  //sliding iterations per move (one per axis plus a corner)
+  #define SWEEP_MAX_ITERATIONS 3
+  //tolerance when converting times of impact back to pixels
+  #define SWEEP_EPSILON 1e-4f
+
+  /**
+   * Get the sign of a value
+   * @param  v the value
+   * @return   -1, 0 or 1
+   */
+  static int sign(int v) {
+    return (v > 0) - (v < 0);
+  }
+
+  /**
+   * Whether a rect overlaps any of a set of rects
+   * @param  bounds the rect
+   * @param  solids the rects to check
+   * @return        whether there is an overlap
+   */
+  bool overlaps_any(const SDL_Rect& bounds, const std::vector<SDL_Rect>& solids) {
+    return aabb_overlap_any(bounds, solids.data(), solids.size());
+  }
+
+  /**
+   * Compute the open interval of time where two ranges overlap on one axis
+   * @param pos      moving start
+   * @param len      moving length
+   * @param d        movement
+   * @param obs_pos  obstacle start
+   * @param obs_len  obstacle length
+   * @param entry    set to the entry time
+   * @param exit     set to the exit time
+   */
+  static void axis_interval(int pos, int len, int d, int obs_pos, int obs_len,
+                            float& entry, float& exit) {
+    const float inf = std::numeric_limits<float>::infinity();
+    if (d == 0) {
+      //overlapping for all time or never
+      bool overlap = (pos < (obs_pos + obs_len)) && ((pos + len) > obs_pos);
+      entry = overlap ? -inf : inf;
+      exit = overlap ? inf : -inf;
+    } else if (d > 0) {
+      entry = (float)(obs_pos - (pos + len)) / d;
+      exit = (float)((obs_pos + obs_len) - pos) / d;
+    } else {
+      entry = (float)((obs_pos + obs_len) - pos) / d;
+      exit = (float)(obs_pos - (pos + len)) / d;
+    }
+  }
+
+  /**
+   * Get the way out of an obstacle a rect overlaps (along the shallowest axis,
+   * ties push out vertically)
+   * @param bounds   the rect
+   * @param obstacle the obstacle
+   * @param out_x    set to the direction out on x (-1, 0 or 1)
+   * @param out_y    set to the direction out on y (-1, 0 or 1)
+   */
+  static void escape_direction(const SDL_Rect& bounds, const SDL_Rect& obstacle,
+                               int& out_x, int& out_y) {
+    int depth_x = std::min(bounds.x + bounds.w, obstacle.x + obstacle.w) -
+                  std::max(bounds.x, obstacle.x);
+    int depth_y = std::min(bounds.y + bounds.h, obstacle.y + obstacle.h) -
+                  std::max(bounds.y, obstacle.y);
+    //centers are doubled to stay in whole pixels
+    int offset_x = ((2 * bounds.x) + bounds.w) - ((2 * obstacle.x) + obstacle.w);
+    int offset_y = ((2 * bounds.y) + bounds.h) - ((2 * obstacle.y) + obstacle.h);
+
+    out_x = 0;
+    out_y = 0;
+    if (depth_x < depth_y) {
+      out_x = (offset_x > 0) ? 1 : -1;
+    } else {
+      out_y = (offset_y > 0) ? 1 : -1;
+    }
+  }
+
+  /**
+   * Whether a move pushes deeper into an obstacle the rect already overlaps
+   * @param  bounds   the rect
+   * @param  dx       movement x
+   * @param  dy       movement y
+   * @param  obstacle the obstacle
+   * @return          whether the move goes against the way out
+   */
+  static bool pushes_deeper(const SDL_Rect& bounds, int dx, int dy, const SDL_Rect& obstacle) {
+    int out_x, out_y;
+    escape_direction(bounds, obstacle, out_x, out_y);
+    return (out_x && (sign(dx) == -out_x)) || (out_y && (sign(dy) == -out_y));
+  }
+
+  /**
+   * Whether moving a rect makes it overlap a solid it didn't overlap before
+   * @param  from     the rect before moving
+   * @param  to       the rect after moving
+   * @param  solids   the solid rects
+   * @param  embedded whether from overlaps any solid (if not, any overlap is new)
+   * @return          whether a new solid is overlapped
+   */
+  static bool enters_any(const SDL_Rect& from, const SDL_Rect& to,
+                         const std::vector<SDL_Rect>& solids, bool embedded) {
+    if (!embedded) {
+      return overlaps_any(to,solids);
+    }
+    for (const SDL_Rect& solid : solids) {
+      if (rect_overlaps(to,solid) && !rect_overlaps(from,solid)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Time of impact of a moving rect against a static rect
+   * (an obstacle already overlapping at the start blocks immediately if the
+   * movement pushes deeper along the shallowest axis, and never otherwise)
+   * @param  bounds   the moving rect
+   * @param  dx       movement x
+   * @param  dy       movement y
+   * @param  obstacle the static rect
+   * @return          time of impact (0-1), or > 1 if no impact
+   */
+  float sweep_aabb(const SDL_Rect& bounds, int dx, int dy, const SDL_Rect& obstacle) {
+    if (rect_overlaps(bounds,obstacle)) {
+      return pushes_deeper(bounds,dx,dy,obstacle) ? 0.0f : std::numeric_limits<float>::infinity();
+    }
+
+    float x_entry, x_exit, y_entry, y_exit;
+    axis_interval(bounds.x, bounds.w, dx, obstacle.x, obstacle.w, x_entry, x_exit);
+    axis_interval(bounds.y, bounds.h, dy, obstacle.y, obstacle.h, y_entry, y_exit);
+
+    float entry = std::max(x_entry, y_entry);
+    float exit = std::min(x_exit, y_exit);
+
+    if ((entry < 0) || (entry >= 1) || (entry >= exit)) {
+      return std::numeric_limits<float>::infinity();
+    }
+    return entry;
+  }
+
+  /**
+   * Move a rect against solid rects, stopping at the first contact
+   * and sliding the rest of the movement along the contact surface
+   * (a body starting inside a solid can move out of it or along it, not deeper)
+   * @param  bounds the starting bounds
+   * @param  dx     movement x
+   * @param  dy     movement y
+   * @param  solids the solid rects
+   * @return        the resolved movement (a body starting inside a solid
+   *                and pushing deeper hits it at time 0)
+   */
+  sweep_result_t sweep_move(const SDL_Rect& bounds, int dx, int dy,
+                            const std::vector<SDL_Rect>& solids) {
+    sweep_result_t result = {bounds, 1.0f, 0, 0};
+    bool hit = false;
+
+    //already inside something (i.e. spawned or resized into a wall),
+    //drop the parts of the movement that push deeper
+    bool embedded = overlaps_any(bounds,solids);
+    if (embedded) {
+      for (const SDL_Rect& solid : solids) {
+        if (rect_overlaps(bounds,solid)) {
+          int out_x, out_y;
+          escape_direction(bounds, solid, out_x, out_y);
+          if (out_x && (sign(dx) == -out_x)) {
+            dx = 0;
+            hit = true;
+            result.time = 0;
+            result.normal_x = out_x;
+          }
+          if (out_y && (sign(dy) == -out_y)) {
+            dy = 0;
+            hit = true;
+            result.time = 0;
+            result.normal_y = out_y;
+          }
+        }
+      }
+    }
+
+    for (int i=0; (i<SWEEP_MAX_ITERATIONS) && (dx || dy); i++) {
+      //earliest impact
+      float time = 1.0f;
+      for (const SDL_Rect& solid : solids) {
+        time = std::min(time, sweep_aabb(result.bounds, dx, dy, solid));
+      }
+
+      //move up to the contact (whole pixels, toward the start)
+      int mx = (int)((dx * time) + (sign(dx) * SWEEP_EPSILON));
+      int my = (int)((dy * time) + (sign(dy) * SWEEP_EPSILON));
+      SDL_Rect moved = {result.bounds.x + mx, result.bounds.y + my,
+                        result.bounds.w, result.bounds.h};
+
+      //pixel rounding can't leave the body in a new solid
+      while ((mx || my) && enters_any(result.bounds,moved,solids,embedded)) {
+        if (std::abs(mx) >= std::abs(my)) {
+          mx -= sign(mx);
+        } else {
+          my -= sign(my);
+        }
+        moved.x = result.bounds.x + mx;
+        moved.y = result.bounds.y + my;
+      }
+
+      result.bounds = moved;
+      dx -= mx;
+      dy -= my;
+
+      if (time >= 1.0f) {
+        break;
+      }
+
+      //find which axes are blocked at the contact
+      SDL_Rect probe_x = {moved.x + sign(dx), moved.y, moved.w, moved.h};
+      SDL_Rect probe_y = {moved.x, moved.y + sign(dy), moved.w, moved.h};
+      bool blocked_x = dx && enters_any(moved,probe_x,solids,embedded);
+      bool blocked_y = dy && enters_any(moved,probe_y,solids,embedded);
+
+      //only the diagonal is blocked (exact corner), land on it
+      if (!blocked_x && !blocked_y) {
+        blocked_y = dy != 0;
+        blocked_x = !blocked_y;
+      }
+
+      if (!hit) {
+        //keep the first contact
+        hit = true;
+        result.time = time;
+        result.normal_x = blocked_x ? -sign(dx) : 0;
+        result.normal_y = blocked_y ? -sign(dy) : 0;
+      }
+
+      //slide along the surface
+      if (blocked_x) {
+        dx = 0;
+      }
+      if (blocked_y) {
+        dy = 0;
+      }
+    }
+    return result;
+  }
+}
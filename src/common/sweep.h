@@ -0,0 +1,63 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_SWEEP_H
+#define _DIVEBAR_COMMON_SWEEP_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+namespace common {
+
+  /*
+   * Result of moving a body against solid rects
+   */
+  struct sweep_result_t {
+    //the resolved bounds
+    SDL_Rect bounds;
+    //time of first impact (0-1, 1 if the move was unobstructed)
+    float time;
+    //contact normal of the first impact (0,0 if none)
+    int normal_x;
+    int normal_y;
+  };
+
+  /**
+   * Whether a rect overlaps any of a set of rects
+   * @param  bounds the rect
+   * @param  solids the rects to check
+   * @return        whether there is an overlap
+   */
+  bool overlaps_any(const SDL_Rect& bounds, const std::vector<SDL_Rect>& solids);
+
+  /**
+   * Time of impact of a moving rect against a static rect
+   * (an obstacle already overlapping at the start blocks immediately if the
+   * movement pushes deeper along the shallowest axis, and never otherwise)
+   * @param  bounds   the moving rect
+   * @param  dx       movement x
+   * @param  dy       movement y
+   * @param  obstacle the static rect
+   * @return          time of impact (0-1), or > 1 if no impact
+   */
+  float sweep_aabb(const SDL_Rect& bounds, int dx, int dy, const SDL_Rect& obstacle);
+
+  /**
+   * Move a rect against solid rects, stopping at the first contact
+   * and sliding the rest of the movement along the contact surface
+   * (a body starting inside a solid can move out of it or along it, not deeper)
+   * @param  bounds the starting bounds
+   * @param  dx     movement x
+   * @param  dy     movement y
+   * @param  solids the solid rects
+   * @return        the resolved movement (a body starting inside a solid
+   *                and pushing deeper hits it at time 0)
+   */
+  sweep_result_t sweep_move(const SDL_Rect& bounds, int dx, int dy,
+                            const std::vector<SDL_Rect>& solids);
+}
+
+#endif /*_DIVEBAR_COMMON_SWEEP_H*/
@@ -0,0 +1,208 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "texture_atlas.h"
+#include "launch_exception.h"
+#include <stdint.h>
+#include <algorithm>
+#include <climits>
+#include <string>
+
+namespace common {
+
+  /**
+   * Constructor
+   * @param width  the width of the packing area
+   * @param height the height of the packing area
+   */
+  skyline_packer_t::skyline_packer_t(int width, int height)
+    : width(width),
+      height(height),
+      skyline({{0,0,width}}) {}
+
+  /**
+   * Find the lowest position a rect fits at starting on a segment
+   * @param  idx the segment to start on
+   * @param  w   the width of the rect
+   * @param  h   the height of the rect
+   * @param  y   the position (set)
+   * @return     whether the rect fits
+   */
+  bool skyline_packer_t::fits(size_t idx, int w, int h, int& y) const {
+    if ((skyline[idx].x + w) > width) {
+      return false;
+    }
+
+    //rest on the highest segment under the rect
+    y = 0;
+    int remaining = w;
+    for (size_t i=idx; remaining > 0; i++) {
+      y = std::max(y, skyline[i].y);
+      if ((y + h) > height) {
+        return false;
+      }
+      remaining -= skyline[i].w;
+    }
+    return true;
+  }
+
+  /**
+   * Place a rect
+   * @param  w      the width of the rect
+   * @param  h      the height of the rect
+   * @param  placed the position of the rect (set)
+   * @return        whether there was room
+   */
+  bool skyline_packer_t::pack(int w, int h, SDL_Rect& placed) {
+    //lowest top edge wins, then leftmost
+    size_t best = skyline.size();
+    int best_top = INT_MAX;
+    int best_y = 0;
+    for (size_t i=0; i<skyline.size(); i++) {
+      int y = 0;
+      if (fits(i, w, h, y) && ((y + h) < best_top)) {
+        best = i;
+        best_top = y + h;
+        best_y = y;
+      }
+    }
+    if (best == skyline.size()) {
+      return false;
+    }
+
+    placed = {skyline[best].x, best_y, w, h};
+
+    //raise the skyline under the rect
+    skyline.insert(skyline.begin() + best, {placed.x, best_top, w});
+    for (size_t i=best + 1; i<skyline.size();) {
+      int covered = (placed.x + w) - skyline[i].x;
+      if (covered <= 0) {
+        break;
+      }
+      if (covered < skyline[i].w) {
+        skyline[i].x += covered;
+        skyline[i].w -= covered;
+        break;
+      }
+      skyline.erase(skyline.begin() + i);
+    }
+
+    //join neighbours at the same height
+    for (size_t i=0; (i + 1) < skyline.size();) {
+      if (skyline[i].y == skyline[i + 1].y) {
+        skyline[i].w += skyline[i + 1].w;
+        skyline.erase(skyline.begin() + i + 1);
+      } else {
+        i++;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Constructor, creates an empty page
+   * @param renderer the renderer to create the texture with
+   */
+  atlas_page_t::atlas_page_t(SDL_Renderer& renderer)
+    : pixels(NULL),
+      texture(NULL),
+      packer(ATLAS_PAGE_DIM, ATLAS_PAGE_DIM) {
+    pixels = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_PAGE_DIM, ATLAS_PAGE_DIM,
+                                            32, SDL_PIXELFORMAT_RGBA32);
+    if (pixels == NULL) {
+      throw launch_exception("could not create atlas page: " + std::string(SDL_GetError()));
+    }
+
+    texture = SDL_CreateTexture(&renderer, SDL_PIXELFORMAT_RGBA32,
+                                SDL_TEXTUREACCESS_STATIC,
+                                ATLAS_PAGE_DIM, ATLAS_PAGE_DIM);
+    if (texture == NULL) {
+      SDL_FreeSurface(pixels);
+      throw launch_exception("could not create atlas texture: " + std::string(SDL_GetError()));
+    }
+
+    //start fully transparent
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_UpdateTexture(texture, NULL, pixels->pixels, pixels->pitch);
+  }
+
+  //free the texture and pixels
+  atlas_page_t::~atlas_page_t() {
+    SDL_DestroyTexture(texture);
+    SDL_FreeSurface(pixels);
+  }
+
+  /**
+   * Constructor
+   * @param renderer the renderer to create pages with
+   */
+  texture_atlas_t::texture_atlas_t(SDL_Renderer& renderer)
+    : renderer(&renderer),
+      pages() {}
+
+  /**
+   * Copy an image into a page (colour keyed pixels become transparent)
+   * @param  surface the image
+   * @param  region  where the image is in the page (set)
+   * @return         the page (or nullptr if the image doesn't fit a page)
+   */
+  std::shared_ptr<atlas_page_t> texture_atlas_t::add(SDL_Surface& surface, SDL_Rect& region) {
+    int w = surface.w + (2 * ATLAS_PADDING);
+    int h = surface.h + (2 * ATLAS_PADDING);
+    if ((w > ATLAS_PAGE_DIM) || (h > ATLAS_PAGE_DIM)) {
+      return nullptr;
+    }
+
+    //forget pages whose images are all gone
+    pages.erase(std::remove_if(pages.begin(), pages.end(),
+                               [](const std::weak_ptr<atlas_page_t>& p) { return p.expired(); }),
+                pages.end());
+
+    //first page with room
+    std::shared_ptr<atlas_page_t> page;
+    SDL_Rect placed;
+    for (const std::weak_ptr<atlas_page_t>& candidate : pages) {
+      std::shared_ptr<atlas_page_t> live = candidate.lock();
+      if (live && live->packer.pack(w, h, placed)) {
+        page = live;
+        break;
+      }
+    }
+    if (!page) {
+      page = std::make_shared<atlas_page_t>(*renderer);
+      page->packer.pack(w, h, placed);
+      pages.push_back(page);
+    }
+
+    region = {placed.x + ATLAS_PADDING, placed.y + ATLAS_PADDING, surface.w, surface.h};
+
+    //copy raw pixels, keyed pixels are skipped and stay transparent
+    SDL_SetSurfaceBlendMode(&surface, SDL_BLENDMODE_NONE);
+    SDL_Rect dest = region;
+    if (SDL_BlitSurface(&surface, NULL, page->pixels, &dest) != 0) {
+      throw launch_exception("could not copy to atlas: " + std::string(SDL_GetError()));
+    }
+
+    //upload only the changed part of the page
+    const uint8_t* changed = (const uint8_t*)page->pixels->pixels +
+                             (region.y * page->pixels->pitch) + (region.x * 4);
+    SDL_UpdateTexture(page->texture, &region, changed, page->pixels->pitch);
+    return page;
+  }
+
+  /**
+   * Get the number of pages still in use
+   * @return the number of pages
+   */
+  size_t texture_atlas_t::page_count() const {
+    size_t count = 0;
+    for (const std::weak_ptr<atlas_page_t>& page : pages) {
+      count += !page.expired();
+    }
+    return count;
+  }
+
+}
@@ -0,0 +1,143 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_TEXTURE_ATLAS_H
+#define _DIVEBAR_COMMON_TEXTURE_ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <memory>
+#include <vector>
+
+namespace common {
+
+  //the size of an atlas page (px, square)
+  #define ATLAS_PAGE_DIM 1024
+  //empty space around each packed image (avoids sampling neighbours)
+  #define ATLAS_PADDING 1
+  //estimated texture memory of a page (RGBA), the same again is kept as a surface
+  #define ATLAS_PAGE_BYTES ((size_t)ATLAS_PAGE_DIM * ATLAS_PAGE_DIM * 4)
+
+  /*
+   * Bottom left skyline rectangle packer
+   */
+  class skyline_packer_t {
+  private:
+    //a horizontal segment of the skyline
+    struct segment_t {
+      int x, y, w;
+    };
+
+    //the size of the packing area
+    int width, height;
+    //the top of the packed area, left to right
+    std::vector<segment_t> skyline;
+
+    /**
+     * Find the lowest position a rect fits at starting on a segment
+     * @param  idx the segment to start on
+     * @param  w   the width of the rect
+     * @param  h   the height of the rect
+     * @param  y   the position (set)
+     * @return     whether the rect fits
+     */
+    bool fits(size_t idx, int w, int h, int& y) const;
+
+  public:
+    /**
+     * Constructor
+     * @param width  the width of the packing area
+     * @param height the height of the packing area
+     */
+    skyline_packer_t(int width, int height);
+
+    /**
+     * Place a rect
+     * @param  w      the width of the rect
+     * @param  h      the height of the rect
+     * @param  placed the position of the rect (set)
+     * @return        whether there was room
+     */
+    bool pack(int w, int h, SDL_Rect& placed);
+  };
+
+  class texture_atlas_t;
+
+  /*
+   * A shared texture images are packed into. Every image on the page
+   * holds it, the page is freed with the last of them. Besides the
+   * texture (ATLAS_PAGE_BYTES) a page keeps a copy of its pixels as a
+   * surface (another ATLAS_PAGE_BYTES of memory) so images can be added
+   * later without reading the texture back
+   */
+  class atlas_page_t {
+  private:
+    friend class texture_atlas_t;
+
+    //the pixels (RGBA)
+    SDL_Surface* pixels;
+    //the texture drawn from
+    SDL_Texture* texture;
+    //free space
+    skyline_packer_t packer;
+
+  public:
+    /**
+     * Constructor, creates an empty page
+     * @param renderer the renderer to create the texture with
+     */
+    explicit atlas_page_t(SDL_Renderer& renderer);
+    atlas_page_t(const atlas_page_t&) = delete;
+    atlas_page_t& operator=(const atlas_page_t&) = delete;
+
+    //free the texture and pixels
+    ~atlas_page_t();
+
+    /**
+     * Get the texture
+     * @return the texture
+     */
+    SDL_Texture* get_texture() const { return texture; }
+  };
+
+  /*
+   * Images packed into a few shared textures (pages) so that sprites
+   * from different sheets can be drawn without switching textures.
+   * Space is only reused once a whole page is freed (render thread only)
+   */
+  class texture_atlas_t {
+  private:
+    //the renderer pages are created with
+    SDL_Renderer* renderer;
+    //the pages (owned by the images on them)
+    std::vector<std::weak_ptr<atlas_page_t>> pages;
+
+  public:
+    /**
+     * Constructor
+     * @param renderer the renderer to create pages with
+     */
+    texture_atlas_t(SDL_Renderer& renderer);
+    texture_atlas_t(const texture_atlas_t&) = delete;
+    texture_atlas_t& operator=(const texture_atlas_t&) = delete;
+
+    /**
+     * Copy an image into a page (colour keyed pixels become transparent)
+     * @param  surface the image
+     * @param  region  where the image is in the page (set)
+     * @return         the page (or nullptr if the image doesn't fit a page)
+     */
+    std::shared_ptr<atlas_page_t> add(SDL_Surface& surface, SDL_Rect& region);
+
+    /**
+     * Get the number of pages still in use
+     * @return the number of pages
+     */
+    size_t page_count() const;
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_TEXTURE_ATLAS_H*/
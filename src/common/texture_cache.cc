@@ -0,0 +1,180 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "texture_cache.h"
+#include <algorithm>
+#include <vector>
+
+namespace common {
+
+  /**
+   * Constructor
+   * @param loader the loader for images that aren't cached
+   * @param budget estimated texture memory to stay under (bytes)
+   */
+  texture_cache_t::texture_cache_t(std::shared_ptr<asset_loader_t> loader,
+                                   size_t budget)
+    : loader(loader),
+      entries(),
+      budget(budget),
+      resident(0),
+      clock(0) {}
+
+  /**
+   * Normalize a path so that equivalent spellings share an entry
+   * (removes empty and . segments and resolves ..)
+   * @param  path the path
+   * @return      the normalized path
+   */
+  std::string texture_cache_t::normalize(const std::string& path) {
+    bool absolute = !path.empty() && (path[0] == '/');
+    std::vector<std::string> segments;
+
+    size_t start = 0;
+    while (start <= path.size()) {
+      size_t end = path.find('/', start);
+      if (end == std::string::npos) {
+        end = path.size();
+      }
+      std::string segment = path.substr(start, end - start);
+      start = end + 1;
+
+      if (segment.empty() || (segment == ".")) {
+        continue;
+      }
+      //.. cancels the previous segment (unless there is nothing to cancel)
+      if ((segment == "..") && !segments.empty() && (segments.back() != "..")) {
+        segments.pop_back();
+      } else if ((segment != "..") || !absolute) {
+        segments.push_back(segment);
+      }
+    }
+
+    std::string normalized = absolute ? "/" : "";
+    for (size_t i=0; i<segments.size(); i++) {
+      if (i > 0) {
+        normalized += '/';
+      }
+      normalized += segments[i];
+    }
+    return normalized;
+  }
+
+  /**
+   * Get the image for a path (loaded in the background on a miss)
+   * @param  renderer the renderer the image will be drawn with
+   * @param  path     the file to load
+   * @return          the shared image
+   */
+  std::shared_ptr<image_t> texture_cache_t::get(SDL_Renderer& renderer,
+                                                const std::string& path) {
+    std::string key = normalize(path);
+
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+      it = entries.emplace(key, entry_t{loader->load_image(renderer, key), 0, 0}).first;
+    }
+    it->second.last_used = ++clock;
+    return it->second.image;
+  }
+
+  /**
+   * Drop unused images and atlas pages (least recently requested
+   * first) until the estimated texture memory is within budget
+   */
+  void texture_cache_t::trim() {
+    struct page_use_t {
+      //everything holding the page
+      long holders;
+      //cached images on the page that only the cache holds
+      long unused;
+      //when one of those was last requested
+      uint64_t last_used;
+    };
+    std::unordered_map<const atlas_page_t*, page_use_t> pages;
+
+    //packed images count as their page, once
+    resident = 0;
+    for (auto& it : entries) {
+      entry_t& entry = it.second;
+      if (!entry.image->is_loaded()) {
+        continue;
+      }
+
+      const std::shared_ptr<atlas_page_t>& page = entry.image->get_page();
+      if (page) {
+        auto use = pages.emplace(page.get(), page_use_t{page.use_count(), 0, 0});
+        if (use.second) {
+          resident += ATLAS_PAGE_BYTES;
+        }
+        if (entry.image.use_count() == 1) {
+          use.first->second.unused++;
+          use.first->second.last_used = std::max(use.first->second.last_used, entry.last_used);
+        }
+      } else {
+        const SDL_Rect& dim = entry.image->default_bounds();
+        entry.bytes = (size_t)dim.w * dim.h * TEXTURE_CACHE_TEXEL_BYTES;
+        resident += entry.bytes;
+      }
+    }
+    if (resident <= budget) {
+      return;
+    }
+
+    //what can be freed: unused images with a texture of their own,
+    //and pages held only by unused cached images
+    struct victim_t {
+      uint64_t last_used;
+      size_t bytes;
+      //the page to drop (nullptr for a single image)
+      const atlas_page_t* page;
+      std::unordered_map<std::string, entry_t>::iterator entry;
+    };
+    std::vector<victim_t> victims;
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+      if ((it->second.bytes > 0) && (it->second.image.use_count() == 1)) {
+        victims.push_back({it->second.last_used, it->second.bytes, nullptr, it});
+      }
+    }
+    for (const auto& use : pages) {
+      if (use.second.unused == use.second.holders) {
+        victims.push_back({use.second.last_used, ATLAS_PAGE_BYTES, use.first, entries.end()});
+      }
+    }
+    std::sort(victims.begin(), victims.end(),
+              [](const victim_t& a, const victim_t& b) {
+                return a.last_used < b.last_used;
+              });
+
+    for (size_t i=0; (i < victims.size()) && (resident > budget); i++) {
+      resident -= victims[i].bytes;
+      if (victims[i].page == nullptr) {
+        entries.erase(victims[i].entry);
+        continue;
+      }
+
+      //the page goes with the last image on it
+      for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.image->is_loaded() &&
+            (it->second.image->get_page().get() == victims[i].page)) {
+          it = entries.erase(it);
+        } else {
+          it++;
+        }
+      }
+    }
+  }
+
+  /**
+   * Change the estimated texture memory to stay under
+   * @param budget the budget (bytes)
+   */
+  void texture_cache_t::set_budget(size_t budget) {
+    this->budget = budget;
+    trim();
+  }
+
+}
@@ -0,0 +1,110 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_COMMON_TEXTURE_CACHE_H
+#define _DIVEBAR_COMMON_TEXTURE_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "image.h"
+#include "asset_loader.h"
+#include "texture_atlas.h"
+
+namespace common {
+
+  //default estimated texture memory kept for images nobody is using (bytes)
+  #define TEXTURE_CACHE_BUDGET (64 * 1024 * 1024)
+  //estimated bytes per texel (RGBA)
+  #define TEXTURE_CACHE_TEXEL_BYTES 4
+
+  /*
+   * Shares one image per resource path, so every entity using a sheet
+   * shares a single decode, upload and texture. Images nobody holds
+   * anymore stay cached until the estimated texture memory goes over
+   * budget, then the least recently requested are dropped.
+   * Packed images count as the whole atlas page they are on, a page is
+   * only dropped (and its memory freed) once no image on it is used
+   */
+  class texture_cache_t {
+  private:
+    struct entry_t {
+      //the shared image
+      std::shared_ptr<image_t> image;
+      //estimated texture memory (0 until loaded, and for packed images)
+      size_t bytes;
+      //when the image was last requested
+      uint64_t last_used;
+    };
+
+    //loads images that aren't cached
+    std::shared_ptr<asset_loader_t> loader;
+    //images by normalized path
+    std::unordered_map<std::string, entry_t> entries;
+    //estimated texture memory to stay under
+    size_t budget;
+    //estimated texture memory of the loaded images and their pages (as of the last trim)
+    size_t resident;
+    //request counter (for least recently used)
+    uint64_t clock;
+
+  public:
+    /**
+     * Constructor
+     * @param loader the loader for images that aren't cached
+     * @param budget estimated texture memory to stay under (bytes)
+     */
+    texture_cache_t(std::shared_ptr<asset_loader_t> loader,
+                    size_t budget=TEXTURE_CACHE_BUDGET);
+    texture_cache_t(const texture_cache_t&) = delete;
+    texture_cache_t& operator=(const texture_cache_t&) = delete;
+
+    /**
+     * Normalize a path so that equivalent spellings share an entry
+     * (removes empty and . segments and resolves ..)
+     * @param  path the path
+     * @return      the normalized path
+     */
+    static std::string normalize(const std::string& path);
+
+    /**
+     * Get the image for a path (loaded in the background on a miss)
+     * @param  renderer the renderer the image will be drawn with
+     * @param  path     the file to load
+     * @return          the shared image
+     */
+    std::shared_ptr<image_t> get(SDL_Renderer& renderer, const std::string& path);
+
+    /**
+     * Drop unused images and atlas pages (least recently requested
+     * first) until the estimated texture memory is within budget
+     */
+    void trim();
+
+    /**
+     * Change the estimated texture memory to stay under
+     * @param budget the budget (bytes)
+     */
+    void set_budget(size_t budget);
+
+    /**
+     * Get the estimated texture memory of the cached images
+     * @return bytes
+     */
+    size_t bytes_resident() const { return resident; }
+
+    /**
+     * Get the number of cached images
+     * @return the number of images
+     */
+    size_t size() const { return entries.size(); }
+  };
+
+}
+
+#endif /*_DIVEBAR_COMMON_TEXTURE_CACHE_H*/
@@ -9,56 +9,208 @@
 #include <unistd.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include "../common/sprite_batch.h"
 #include <chrono>
+#include <iostream>
 
 namespace engine {
 
+  /**
+   * Print the throughput of a run without a window
+   * @param label      the type of run
+   * @param ticks      the ticks completed
+   * @param elapsed_ms the total time taken
+   */
+  static void report_ticks(const std::string& label, unsigned long ticks, double elapsed_ms) {
+    std::cout << label << ": " << ticks << " ticks in " << elapsed_ms << " ms ("
+              << (elapsed_ms > 0 ? (ticks * 1000.0 / elapsed_ms) : 0) << " ticks/s, "
+              << (ticks > 0 ? (elapsed_ms * 1000.0 / ticks) : 0) << " us/tick)"
+              << std::endl;
+  }
+
   /**
    * Start the game loop
    * @param  win the window
    * @param  man the state manager
+   * @param  recorder optionally record input events
+   * @param  profile_path file to write frame timings to on exit (or empty)
    * @return     exit status
    */
   int game_loop(std::shared_ptr<window::window_t> win,
-                std::shared_ptr<state::manager_t> man) {
+                std::shared_ptr<state::manager_t> man,
+                std::shared_ptr<recorder_t> recorder,
+                const std::string& profile_path) {
 
-    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+    //time not yet consumed by ticks (sub-millisecond precision)
+    double accumulator_ms = 0;
+    //ticks completed (tags recorded events)
+    uint32_t tick = 0;
     SDL_Event e;
+    //frame timings
+    profiler_t profiler;
 
     while (true) {
       //check events
       while (SDL_PollEvent(&e) != 0) {
         //check for a quit event
         if (e.type == SDL_QUIT) {
+          if (recorder) {
+            recorder->finish(tick);
+          }
+          if (!profile_path.empty()) {
+            profiler.dump(profile_path);
+          }
           return EXIT_SUCCESS;
         } else {
+          if (recorder) {
+            recorder->record(tick,e);
+          }
+          //toggle the profiler overlay
+          if ((e.type == SDL_KEYDOWN) && (e.key.keysym.sym == PROFILER_KEY)) {
+            profiler.toggle_overlay();
+          }
           //handle event
           man->handle_event_manager(e);
         }
       }
 
-      //get time since last update
+      //add the time since the last frame to the accumulator
       std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-      int elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+      float frame_ms = std::chrono::duration<float, std::milli>(now - last).count();
+      accumulator_ms += frame_ms;
+      last = now;
+
+      frame_sample_t sample = {0,0,0,frame_ms,0,0};
+
+      //run as many fixed ticks as have elapsed (bounded)
+      while ((accumulator_ms >= TICK_SLEEP) && (sample.ticks < MAX_CATCHUP_TICKS)) {
+        scoped_timer_t timer(sample.update_ms);
+        //a crash during the update ends the recording after this tick
+        if (recorder) {
+          recorder->begin_tick(tick);
+        }
+        //update the state
+        man->update_manager();
+        accumulator_ms -= TICK_SLEEP;
+        sample.ticks++;
+        tick++;
+      }
+
+      //too far behind to catch up, drop whole ticks but keep the remainder
+      while (accumulator_ms >= TICK_SLEEP) {
+        accumulator_ms -= TICK_SLEEP;
+      }
+
+      {
+        scoped_timer_t timer(sample.render_ms);
+
+        //finish a few images decoded in the background
+        man->upload_assets();
+
+        //clear the screen
+        win->clear_screen();
+
+        //draw the window contents (interpolated between the last two ticks)
+        man->render_manager(win->get_renderer(), (float)(accumulator_ms / TICK_SLEEP));
+
+        //draw frame timings on top
+        profiler.render_overlay(win->get_renderer());
+      }
+      sample.draw_calls = common::sprite_batch_t::take_draw_calls();
+
+      {
+        scoped_timer_t timer(sample.present_ms);
+        //render the repaint
+        win->render();
+      }
+
+      profiler.push(sample);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  /**
+   * Run the simulation without a window as fast as possible
+   * @param  man   the state manager
+   * @param  ticks the number of ticks to run
+   * @return       exit status
+   */
+  int headless_loop(std::shared_ptr<state::manager_t> man,
+                    unsigned long ticks) {
 
-      //check if tick elapsed
-      if (elapsed_ms >= TICK_SLEEP) {
-        //restart the timer
-        start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SDL_Event e;
+    unsigned long tick = 0;
+    bool quit = false;
+
+    while (!quit && (tick < ticks)) {
+      //check events (no sleeping between ticks)
+      while (!quit && (SDL_PollEvent(&e) != 0)) {
+        if (e.type == SDL_QUIT) {
+          quit = true;
+        } else {
+          man->handle_event_manager(e);
+        }
+      }
+
+      if (!quit) {
         //update the state
         man->update_manager();
+        tick++;
+
+        //nothing is drawn, but decoded images still need their textures (frees the pixels)
+        man->upload_assets();
       }
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    //report throughput
+    report_ticks("headless",tick,elapsed_ms);
+
+    return EXIT_SUCCESS;
+  }
+
+  /**
+   * Replay recorded input without a window as fast as possible
+   * @param  man    the state manager
+   * @param  replay the recording
+   * @return        exit status
+   */
+  int replay_loop(std::shared_ptr<state::manager_t> man,
+                  std::shared_ptr<replay_t> replay) {
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SDL_Event e;
+    uint32_t tick = 0;
 
-      //clear the screen
-      win->clear_screen();
+    while (true) {
+      //feed in the events recorded before this tick
+      while (replay->poll(tick,e)) {
+        man->handle_event_manager(e);
+      }
 
-      //draw the window contents
-      man->render_manager(win->get_renderer());
+      //check if the session ended here
+      if (replay->finished(tick)) {
+        break;
+      }
 
-      //render the repaint
-      win->render();
+      //update the state
+      man->update_manager();
+      tick++;
 
+      //nothing is drawn, but decoded images still need their textures (frees the pixels)
+      man->upload_assets();
     }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    //report throughput
+    report_ticks("replay",tick,elapsed_ms);
+
     return EXIT_SUCCESS;
   }
 }
@@ -10,20 +10,48 @@
 #include <memory>
 #include "../window/window.h"
 #include "../state/manager.h"
+#include "recorder.h"
+#include "profiler.h"
 
 namespace engine {
 
   //ms per tick
   const int TICK_SLEEP = 50;
+  //max ticks to run in a single frame when catching up
+  const int MAX_CATCHUP_TICKS = 5;
+  //toggles the profiler overlay
+  const SDL_Keycode PROFILER_KEY = SDLK_F3;
 
   /**
    * Start the game loop
    * @param  win the window
    * @param  man the state manager
+   * @param  recorder optionally record input events
+   * @param  profile_path file to write frame timings to on exit (or empty)
    * @return     exit status
    */
   int game_loop(std::shared_ptr<window::window_t> win,
-                std::shared_ptr<state::manager_t> man);
+                std::shared_ptr<state::manager_t> man,
+                std::shared_ptr<recorder_t> recorder=nullptr,
+                const std::string& profile_path="");
+
+  /**
+   * Run the simulation without a window as fast as possible
+   * @param  man   the state manager
+   * @param  ticks the number of ticks to run
+   * @return       exit status
+   */
+  int headless_loop(std::shared_ptr<state::manager_t> man,
+                    unsigned long ticks);
+
+  /**
+   * Replay recorded input without a window as fast as possible
+   * @param  man    the state manager
+   * @param  replay the recording
+   * @return        exit status
+   */
+  int replay_loop(std::shared_ptr<state::manager_t> man,
+                  std::shared_ptr<replay_t> replay);
 }
 
 #endif /*_DIVEBAR_ENGINE_LOOP_H*/
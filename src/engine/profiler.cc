@@ -0,0 +1,209 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "profiler.h"
+#include "../common/text.h"
+#include "../common/launch_exception.h"
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+
+namespace engine {
+
+  /*
+   * Summary of frame times (ms)
+   */
+  struct frame_stats_t {
+    float min_ms;
+    float avg_ms;
+    float p99_ms;
+  };
+
+  /**
+   * Compute min, avg and p99 frame time
+   * @param  frames the frames
+   * @param  n      the number of frames
+   * @return        the summary
+   */
+  static frame_stats_t compute_stats(const std::array<frame_sample_t, PROFILER_FRAMES>& frames, size_t n) {
+    if (n == 0) {
+      return {0,0,0};
+    }
+    std::vector<float> times(n);
+    float total = 0;
+    for (size_t i=0; i<n; i++) {
+      times[i] = frames[i].frame_ms;
+      total += times[i];
+    }
+    std::sort(times.begin(), times.end());
+    return {times.front(), total / n, times[std::min(n - 1, (n * 99) / 100)]};
+  }
+
+  /**
+   * Format a labeled timing
+   * @param  label the label
+   * @param  ms    the timing
+   * @return       the text
+   */
+  static std::string format_ms(const char* label, float ms) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%s %5.1fms", label, ms);
+    return std::string(buf);
+  }
+
+  /**
+   * Constructor
+   */
+  profiler_t::profiler_t()
+    : samples(),
+      head(0),
+      overlay(false),
+      overlay_text(),
+      text_refresh(0) {}
+
+  /**
+   * Add a frame
+   * @param sample the frame timings
+   */
+  void profiler_t::push(const frame_sample_t& sample) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    samples[h & (PROFILER_FRAMES - 1)] = sample;
+    //publish the sample
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  /**
+   * Copy out the stored frames (oldest first)
+   * @param  out buffer to copy to
+   * @return     the number of frames copied
+   */
+  size_t profiler_t::snapshot(std::array<frame_sample_t, PROFILER_FRAMES>& out) const {
+    uint64_t h = head.load(std::memory_order_acquire);
+    size_t n = (size_t)std::min<uint64_t>(h, PROFILER_FRAMES);
+    for (size_t i=0; i<n; i++) {
+      out[i] = samples[(h - n + i) & (PROFILER_FRAMES - 1)];
+    }
+    return n;
+  }
+
+  /**
+   * Draw min/avg/p99 frame times, draw calls and a frame time graph
+   * @param renderer the sdl renderer
+   */
+  void profiler_t::render_overlay(SDL_Renderer& renderer) {
+    if (!overlay) {
+      return;
+    }
+
+    std::array<frame_sample_t, PROFILER_FRAMES> frames;
+    size_t n = snapshot(frames);
+
+    //rebuild the text periodically (creates textures)
+    if (--text_refresh <= 0) {
+      frame_stats_t stats = compute_stats(frames, n);
+      overlay_text[0] = common::image_from_text(format_ms("min",stats.min_ms),renderer,0xFF,0xFF,0xFF);
+      overlay_text[1] = common::image_from_text(format_ms("avg",stats.avg_ms),renderer,0xFF,0xFF,0xFF);
+      overlay_text[2] = common::image_from_text(format_ms("p99",stats.p99_ms),renderer,0xFF,0xFF,0xFF);
+      //draw calls of the last frame
+      char draws[32];
+      snprintf(draws, sizeof(draws), "draws %5u", n > 0 ? (unsigned int)frames[n - 1].draw_calls : 0u);
+      overlay_text[3] = common::image_from_text(draws,renderer,0xFF,0xFF,0xFF);
+      text_refresh = PROFILER_TEXT_REFRESH;
+    }
+
+    //get the logical size
+    int w = 0;
+    int h = 0;
+    SDL_RenderGetLogicalSize(&renderer,&w,&h);
+
+    //text background
+    SDL_Rect text_bg = {0, 0, 0, 0};
+    for (size_t i=0; i<overlay_text.size(); i++) {
+      text_bg.w = std::max(text_bg.w, overlay_text[i]->default_bounds().w);
+      text_bg.h += overlay_text[i]->default_bounds().h;
+    }
+    SDL_SetRenderDrawColor(&renderer,0,0,0,0xFF);
+    SDL_RenderFillRect(&renderer,&text_bg);
+
+    //draw the text
+    int y = 0;
+    for (size_t i=0; i<overlay_text.size(); i++) {
+      const SDL_Rect& text_bounds = overlay_text[i]->default_bounds();
+      SDL_Rect render_bounds = {0, y, text_bounds.w, text_bounds.h};
+      overlay_text[i]->render_copy(renderer,text_bounds,render_bounds);
+      y += text_bounds.h;
+    }
+
+    //graph background
+    SDL_Rect graph_bg = {0, h - PROFILER_GRAPH_H, w, PROFILER_GRAPH_H};
+    SDL_SetRenderDrawColor(&renderer,0,0,0,0xFF);
+    SDL_RenderFillRect(&renderer,&graph_bg);
+
+    //one column per frame, most recent on the right
+    size_t columns = std::min(n, (size_t)w);
+    for (size_t i=0; i<columns; i++) {
+      const frame_sample_t& frame = frames[n - columns + i];
+      int x = w - (int)columns + (int)i;
+      int frame_px = std::min((int)(frame.frame_ms / PROFILER_GRAPH_MS_PER_PX), PROFILER_GRAPH_H);
+      int update_px = std::min((int)(frame.update_ms / PROFILER_GRAPH_MS_PER_PX), frame_px);
+
+      //whole frame
+      SDL_SetRenderDrawColor(&renderer,0xFF,0xFF,0,0xFF);
+      SDL_RenderDrawLine(&renderer, x, h - 1, x, h - frame_px);
+      //update portion
+      if (update_px > 0) {
+        SDL_SetRenderDrawColor(&renderer,0xFF,0,0,0xFF);
+        SDL_RenderDrawLine(&renderer, x, h - 1, x, h - update_px);
+      }
+    }
+  }
+
+  /**
+   * Write the stored frames to a file (json if the path
+   * ends in .json, otherwise csv)
+   * @param path the file to write
+   */
+  void profiler_t::dump(const std::string& path) const {
+    std::array<frame_sample_t, PROFILER_FRAMES> frames;
+    size_t n = snapshot(frames);
+    frame_stats_t stats = compute_stats(frames, n);
+
+    std::ofstream file(path);
+    if (!file.good()) {
+      throw common::launch_exception("failed to open profile output: " + path);
+    }
+
+    bool json = (path.size() >= 5) && (path.compare(path.size() - 5, 5, ".json") == 0);
+
+    if (json) {
+      file << "{\n  \"summary\": {\"min_ms\": " << stats.min_ms
+           << ", \"avg_ms\": " << stats.avg_ms
+           << ", \"p99_ms\": " << stats.p99_ms << "},\n  \"frames\": [\n";
+      for (size_t i=0; i<n; i++) {
+        file << "    {\"update_ms\": " << frames[i].update_ms
+             << ", \"render_ms\": " << frames[i].render_ms
+             << ", \"present_ms\": " << frames[i].present_ms
+             << ", \"frame_ms\": " << frames[i].frame_ms
+             << ", \"ticks\": " << frames[i].ticks
+             << ", \"draw_calls\": " << frames[i].draw_calls << "}"
+             << ((i + 1) < n ? ",\n" : "\n");
+      }
+      file << "  ]\n}\n";
+
+    } else {
+      file << "frame,update_ms,render_ms,present_ms,frame_ms,ticks,draw_calls\n";
+      for (size_t i=0; i<n; i++) {
+        file << i << "," << frames[i].update_ms
+             << "," << frames[i].render_ms
+             << "," << frames[i].present_ms
+             << "," << frames[i].frame_ms
+             << "," << frames[i].ticks
+             << "," << frames[i].draw_calls << "\n";
+      }
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_ENGINE_PROFILER_H
+#define _DIVEBAR_ENGINE_PROFILER_H
+
+#include <SDL2/SDL.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <stdint.h>
+#include "../common/image.h"
+
+namespace engine {
+
+  //frames kept by the profiler (power of 2)
+  #define PROFILER_FRAMES 256
+  //frames between overlay text refreshes
+  #define PROFILER_TEXT_REFRESH 15
+  //overlay graph height in px and ms per px
+  #define PROFILER_GRAPH_H 16
+  #define PROFILER_GRAPH_MS_PER_PX 2
+
+  /*
+   * Timings for a single frame (ms)
+   */
+  struct frame_sample_t {
+    float update_ms;
+    float render_ms;
+    float present_ms;
+    float frame_ms;
+    //the number of ticks run this frame
+    uint32_t ticks;
+    //the number of draw calls made this frame
+    uint32_t draw_calls;
+  };
+
+  /*
+   * Adds the time spent in a scope to a timing
+   */
+  struct scoped_timer_t {
+  private:
+    //the timing to add to
+    float& target_ms;
+    //when the scope was entered
+    std::chrono::steady_clock::time_point start;
+
+  public:
+    /**
+     * Constructor
+     * @param target_ms the timing to add to
+     */
+    scoped_timer_t(float& target_ms)
+      : target_ms(target_ms),
+        start(std::chrono::steady_clock::now()) {}
+    scoped_timer_t(const scoped_timer_t&) = delete;
+    scoped_timer_t& operator=(const scoped_timer_t&) = delete;
+
+    //add the elapsed time
+    ~scoped_timer_t() {
+      target_ms += std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    }
+  };
+
+  /*
+   * Keeps timings for the last PROFILER_FRAMES frames
+   * (single producer ring buffer, readers never block the game loop)
+   */
+  class profiler_t {
+  private:
+    //the ring of samples
+    std::array<frame_sample_t, PROFILER_FRAMES> samples;
+    //total frames pushed
+    std::atomic<uint64_t> head;
+    //whether the overlay is shown
+    bool overlay;
+    //cached overlay text (min, avg, p99, draw calls)
+    std::array<std::shared_ptr<common::image_t>, 4> overlay_text;
+    //frames until the overlay text is rebuilt
+    int text_refresh;
+
+  public:
+    /**
+     * Constructor
+     */
+    profiler_t();
+    profiler_t(const profiler_t&) = delete;
+    profiler_t& operator=(const profiler_t&) = delete;
+
+    /**
+     * Add a frame
+     * @param sample the frame timings
+     */
+    void push(const frame_sample_t& sample);
+
+    /**
+     * Copy out the stored frames (oldest first)
+     * @param  out buffer to copy to
+     * @return     the number of frames copied
+     */
+    size_t snapshot(std::array<frame_sample_t, PROFILER_FRAMES>& out) const;
+
+    /**
+     * Toggle the overlay
+     */
+    void toggle_overlay() { overlay = !overlay; }
+
+    /**
+     * Draw min/avg/p99 frame times, draw calls and a frame time graph
+     * @param renderer the sdl renderer
+     */
+    void render_overlay(SDL_Renderer& renderer);
+
+    /**
+     * Write the stored frames to a file (json if the path
+     * ends in .json, otherwise csv)
+     * @param path the file to write
+     */
+    void dump(const std::string& path) const;
+  };
+
+}
+
+#endif /*_DIVEBAR_ENGINE_PROFILER_H*/
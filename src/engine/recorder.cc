@@ -0,0 +1,161 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "recorder.h"
+#include "../common/launch_exception.h"
+#include <cstring>
+#include <algorithm>
+
+namespace engine {
+
+  #define RECORDING_MAGIC "DBIR"
+  #define RECORDING_VERSION 1
+  #define RECORD_END 0
+
+  /**
+   * Write a little endian value
+   * @param file  the file
+   * @param value the value
+   * @param bytes the number of bytes to write
+   */
+  static void write_le(std::ofstream& file, uint32_t value, size_t bytes) {
+    for (size_t i=0; i<bytes; i++) {
+      file.put((char)((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  /**
+   * Read a little endian value
+   * @param file  the file
+   * @param bytes the number of bytes to read
+   * @return      the value
+   */
+  static uint32_t read_le(std::ifstream& file, size_t bytes) {
+    uint32_t value = 0;
+    for (size_t i=0; i<bytes; i++) {
+      int c = file.get();
+      if (c == EOF) {
+        throw common::launch_exception("unexpected end of recording");
+      }
+      value |= ((uint32_t)(c & 0xFF)) << (8 * i);
+    }
+    return value;
+  }
+
+  /**
+   * Constructor
+   * @param path the file to record to
+   */
+  recorder_t::recorder_t(const std::string& path)
+    : file(path, std::ios::binary | std::ios::trunc),
+      ticks_started(0) {
+    if (!file.good()) {
+      throw common::launch_exception("failed to open recording for writing: " + path);
+    }
+    file.write(RECORDING_MAGIC, 4);
+    file.put((char)RECORDING_VERSION);
+  }
+
+  //writes the end marker
+  recorder_t::~recorder_t() {
+    if (file.is_open()) {
+      finish(ticks_started);
+    }
+  }
+
+  /**
+   * Record an event
+   * @param tick the number of ticks completed before the event
+   * @param e    the event
+   */
+  void recorder_t::record(uint32_t tick, const SDL_Event& e) {
+    //only key events keep their fields (see recorder_t)
+    bool key = (e.type == SDL_KEYDOWN) || (e.type == SDL_KEYUP);
+
+    write_le(file, tick, 4);
+    write_le(file, e.type, 4);
+    write_le(file, key ? (uint32_t)e.key.keysym.sym : 0, 4);
+    write_le(file, key ? e.key.keysym.mod : 0, 2);
+    write_le(file, key ? e.key.repeat : 0, 1);
+    //events come before the tick they are tagged with
+    ticks_started = std::max(ticks_started, tick);
+  }
+
+  /**
+   * Record the end of the session
+   * @param tick the total number of ticks
+   */
+  void recorder_t::finish(uint32_t tick) {
+    write_le(file, tick, 4);
+    write_le(file, RECORD_END, 4);
+    //empty sym, mod and repeat
+    write_le(file, 0, 4);
+    write_le(file, 0, 2);
+    write_le(file, 0, 1);
+    file.close();
+  }
+
+  /**
+   * Constructor
+   * @param path the recording to load
+   */
+  replay_t::replay_t(const std::string& path)
+    : file(path, std::ios::binary),
+      next_tick(0),
+      ended(false) {
+    char magic[4];
+    if (!file.read(magic, 4) || (std::memcmp(magic, RECORDING_MAGIC, 4) != 0)) {
+      throw common::launch_exception("not a recording: " + path);
+    }
+    if (file.get() != RECORDING_VERSION) {
+      throw common::launch_exception("unsupported recording version: " + path);
+    }
+    read_next();
+  }
+
+  /**
+   * Read the next record
+   */
+  void replay_t::read_next() {
+    std::memset(&next_event, 0, sizeof(next_event));
+
+    next_tick = read_le(file, 4);
+    next_event.type = read_le(file, 4);
+    next_event.key.keysym.sym = (SDL_Keycode)read_le(file, 4);
+    next_event.key.keysym.mod = (Uint16)read_le(file, 2);
+    next_event.key.repeat = (Uint8)read_le(file, 1);
+
+    if ((next_event.type == SDL_KEYDOWN) || (next_event.type == SDL_KEYUP)) {
+      next_event.key.state = (next_event.type == SDL_KEYDOWN) ? SDL_PRESSED : SDL_RELEASED;
+    }
+
+    ended = next_event.type == RECORD_END;
+  }
+
+  /**
+   * Get the next event for a tick
+   * @param  tick the current tick
+   * @param  e    set to the event
+   * @return      whether there was an event for this tick
+   */
+  bool replay_t::poll(uint32_t tick, SDL_Event& e) {
+    if (ended || (next_tick > tick)) {
+      return false;
+    }
+    e = next_event;
+    read_next();
+    return true;
+  }
+
+  /**
+   * Whether the recording has finished at this tick
+   * @param  tick the current tick
+   * @return      whether the recording is complete
+   */
+  bool replay_t::finished(uint32_t tick) const {
+    return ended && (tick >= next_tick);
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_ENGINE_RECORDER_H
+#define _DIVEBAR_ENGINE_RECORDER_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <string>
+#include <fstream>
+
+namespace engine {
+
+  /*
+   * Records input events (tagged by tick) to a binary file
+   *
+   * Format: magic "DBIR", uint8 version, then records of
+   * uint32 tick, uint32 type, int32 sym, uint16 mod, uint8 repeat
+   * (little endian). A record with type 0 marks the end (tick = total ticks).
+   *
+   * Only SDL_KEYDOWN and SDL_KEYUP replay faithfully (sym, mod, repeat and
+   * state, which is all the game reads). Other events keep just their type
+   * and tick, every other field replays as zero (i.e. window, timestamp,
+   * scancode, mouse and text input are lost).
+   */
+  class recorder_t {
+  private:
+    //the output file
+    std::ofstream file;
+    //ticks started so far (the end tick if the session ends without finish,
+    //i.e. the loop unwinding from a crash, so the replay runs the failing tick)
+    uint32_t ticks_started;
+
+  public:
+    /**
+     * Constructor
+     * @param path the file to record to
+     */
+    recorder_t(const std::string& path);
+    recorder_t(const recorder_t&) = delete;
+    recorder_t& operator=(const recorder_t&) = delete;
+
+    //writes the end marker
+    ~recorder_t();
+
+    /**
+     * Record an event
+     * @param tick the number of ticks completed before the event
+     * @param e    the event
+     */
+    void record(uint32_t tick, const SDL_Event& e);
+
+    /**
+     * Note that a tick is starting (call before each update)
+     * @param tick the number of ticks completed before this one
+     */
+    void begin_tick(uint32_t tick) { ticks_started = tick + 1; }
+
+    /**
+     * Record the end of the session
+     * @param tick the total number of ticks
+     */
+    void finish(uint32_t tick);
+  };
+
+  /*
+   * Reads a recording back
+   */
+  class replay_t {
+  private:
+    //the input file
+    std::ifstream file;
+    //the next record (read ahead)
+    uint32_t next_tick;
+    SDL_Event next_event;
+    //whether the end marker has been read
+    bool ended;
+
+    /**
+     * Read the next record
+     */
+    void read_next();
+
+  public:
+    /**
+     * Constructor
+     * @param path the recording to load
+     */
+    replay_t(const std::string& path);
+    replay_t(const replay_t&) = delete;
+    replay_t& operator=(const replay_t&) = delete;
+
+    /**
+     * Get the next event for a tick
+     * @param  tick the current tick
+     * @param  e    set to the event
+     * @return      whether there was an event for this tick
+     */
+    bool poll(uint32_t tick, SDL_Event& e);
+
+    /**
+     * Whether the recording has finished at this tick
+     * @param  tick the current tick
+     * @return      whether the recording is complete
+     */
+    bool finished(uint32_t tick) const;
+  };
+
+}
+
+#endif /*_DIVEBAR_ENGINE_RECORDER_H*/
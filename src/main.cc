@@ -8,15 +8,25 @@
 #include <unistd.h>
 #include <iostream>
 #include <memory>
+#include <string>
 #include "window/window.h"
+#include "window/headless.h"
 #include "engine/loop.h"
 #include "state/manager.h"
 #include "common/launch_exception.h"
 
+//ticks to run in headless mode if not specified
+#define DEFAULT_HEADLESS_TICKS 1000
+
 /**
  * Load resources, start
+ * @param rsrc_path   the resource directory
+ * @param record_path file to record input to (or empty)
+ * @param profile_path file to write frame timings to on exit (or empty)
  */
-int start(const std::string& rsrc_path) {
+int start(const std::string& rsrc_path,
+          const std::string& record_path,
+          const std::string& profile_path) {
   //create a new window
   std::shared_ptr<window::window_t> window =
     std::make_shared<window::window_t>(window::DEFAULT_TITLE);
@@ -25,8 +35,52 @@ int start(const std::string& rsrc_path) {
   std::shared_ptr<state::manager_t> manager =
     std::make_shared<state::manager_t>(window->get_renderer(),rsrc_path);
 
+  //optionally record input
+  std::shared_ptr<engine::recorder_t> recorder;
+  if (!record_path.empty()) {
+    recorder = std::make_shared<engine::recorder_t>(record_path);
+  }
+
   //start the engine game loop
-  return engine::game_loop(window,manager);
+  return engine::game_loop(window,manager,recorder,profile_path);
+}
+
+/**
+ * Load resources, run the simulation with no window
+ * @param rsrc_path the resource directory
+ * @param ticks     the number of ticks to run
+ */
+int start_headless(const std::string& rsrc_path, unsigned long ticks) {
+  //create an offscreen renderer
+  window::headless_t headless;
+
+  //create a new game manager
+  std::shared_ptr<state::manager_t> manager =
+    std::make_shared<state::manager_t>(headless.get_renderer(),rsrc_path);
+
+  //run the simulation
+  return engine::headless_loop(manager,ticks);
+}
+
+/**
+ * Load resources, replay recorded input with no window
+ * @param rsrc_path   the resource directory
+ * @param replay_path the recording to replay
+ */
+int start_replay(const std::string& rsrc_path, const std::string& replay_path) {
+  //load the recording first (fail fast)
+  std::shared_ptr<engine::replay_t> replay =
+    std::make_shared<engine::replay_t>(replay_path);
+
+  //create an offscreen renderer
+  window::headless_t headless;
+
+  //create a new game manager
+  std::shared_ptr<state::manager_t> manager =
+    std::make_shared<state::manager_t>(headless.get_renderer(),rsrc_path);
+
+  //replay the session
+  return engine::replay_loop(manager,replay);
 }
 
 /**
@@ -34,11 +88,58 @@ int start(const std::string& rsrc_path) {
  */
 int main(int argc, char **argv) {
   std::string rsrc_path = "resources/";
+  bool headless = false;
+  unsigned long ticks = DEFAULT_HEADLESS_TICKS;
+  std::string record_path;
+  std::string replay_path;
+  std::string profile_path;
+
+  //parse arguments
+  for (int i=1; i<argc; i++) {
+    std::string arg(argv[i]);
+
+    if (arg == "--headless") {
+      headless = true;
+
+    } else if ((arg == "--ticks") && ((i + 1) < argc)) {
+      try {
+        ticks = std::stoul(argv[++i]);
+      } catch (...) {
+        std::cerr << "invalid tick count: " << argv[i] << std::endl;
+        return EXIT_FAILURE;
+      }
+
+    } else if ((arg == "--record") && ((i + 1) < argc)) {
+      record_path = argv[++i];
+
+    } else if ((arg == "--replay") && ((i + 1) < argc)) {
+      replay_path = argv[++i];
+
+    } else if ((arg == "--profile") && ((i + 1) < argc)) {
+      profile_path = argv[++i];
+
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--headless [--ticks N]] [--record FILE] [--replay FILE]"
+                << " [--profile FILE.csv|FILE.json]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   try {
-    return start(rsrc_path);
+    if (!replay_path.empty()) {
+      return start_replay(rsrc_path,replay_path);
+    } else if (headless) {
+      return start_headless(rsrc_path,ticks);
+    }
+    return start(rsrc_path,record_path,profile_path);
   } catch (const common::launch_exception& e) {
     std::cerr << e.trace() << std::endl;
     return EXIT_FAILURE;
+  } catch (const std::exception& e) {
+    //caught so the stack unwinds (closing any recording up to the failing tick)
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
   }
 
   return EXIT_SUCCESS;
@@ -17,7 +17,9 @@ namespace actions {
    */
   action_t::action_t()
     : common::component_t({0,0,0,0}, COMPONENT_VISIBLE),
-      flags(0) {}
+      flags(0) {
+    add_kind(COMPONENT_KIND_ACTION);
+  }
 
   /**
    * Set the action completed
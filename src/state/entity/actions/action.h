@@ -33,6 +33,10 @@ namespace actions {
     void set_completed(bool completed);
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_ACTION;
+    typedef action_t component_kind_owner_t;
+
     /**
      * Constructor
      */
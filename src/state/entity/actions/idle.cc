@@ -17,8 +17,8 @@ namespace actions {
    */
   idle_t::idle_t(std::unique_ptr<common::anim_t> idle_anim)
     : action_t(),
-      anim_child_idx(0) {
-    anim_child_idx = this->add_child(std::move(idle_anim));
+      anim_child_idx() {
+    anim_child_idx = this->add_child_as(std::move(idle_anim));
   }
 
   /**
@@ -48,7 +48,7 @@ namespace actions {
     common::component_t::update(parent);
 
     //update the animation direction
-    this->get_nth_child<common::anim_t>(anim_child_idx).set_flipped(
+    this->get_child(anim_child_idx).set_flipped(
       //flip the active animation based on the entity direction
       parent.get_as<entity_t>().facing_left()
     );
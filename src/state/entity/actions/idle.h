@@ -26,7 +26,7 @@ namespace actions {
   class idle_t : public action_t {
   private:
     //the index of the animation
-    size_t anim_child_idx;
+    common::child_handle_t<common::anim_t> anim_child_idx;
 
     /**
      * Load any resources for this component
@@ -25,13 +25,13 @@ namespace actions {
     : action_t(),
       walking_up(false),
       walking_down(false),
-      walking_action(0),
-      climbing_up_action(0),
-      climbing_down_action(0) {
+      walking_action(),
+      climbing_up_action(),
+      climbing_down_action() {
     //add the animations as children of this component
-    walking_action = this->add_child(std::move(flat_anim));
-    climbing_up_action = this->add_child(std::move(up_anim));
-    climbing_down_action = this->add_child(std::move(down_anim));
+    walking_action = this->add_child_as(std::move(flat_anim));
+    climbing_up_action = this->add_child_as(std::move(up_anim));
+    climbing_down_action = this->add_child_as(std::move(down_anim));
   }
 
   /**
@@ -101,11 +101,11 @@ namespace actions {
 
         if (walking_down) {
           //reset the walk down animation
-          this->get_nth_child<common::anim_t>(climbing_down_action).reset_animation();
+          this->get_child(climbing_down_action).reset_animation();
         }
       } else {
         //reset the walk up animation
-        this->get_nth_child<common::anim_t>(climbing_up_action).reset_animation();
+        this->get_child(climbing_up_action).reset_animation();
       }
     }
 
@@ -132,7 +132,7 @@ namespace actions {
     const SDL_Rect& current_position = parent.get_bounds();
 
     //get the climbing animation
-    const common::anim_t& climbing_anim = this->get_nth_child<common::anim_t>(climbing_up_action);
+    const common::anim_t& climbing_anim = this->get_child(climbing_up_action);
 
     //get the level to set the camera
     component_t *grandparent;
@@ -141,8 +141,8 @@ namespace actions {
       if (climbing_anim.anim_complete()) {
         walking_up = false;
 
-        //this mutates current_position
-        parent.set_position(
+        //this mutates current_position (a snap, the step corner isn't swept)
+        parent.snap_position(
           facing_left ? (current_position.x - 8) : (current_position.x + 8),
           current_position.y - 8
         );
@@ -183,7 +183,7 @@ namespace actions {
     const SDL_Rect& current_position = parent.get_bounds();
 
     //get the climbing animation
-    const common::anim_t& climbing_anim = this->get_nth_child<common::anim_t>(climbing_down_action);
+    const common::anim_t& climbing_anim = this->get_child(climbing_down_action);
 
     //get the level to set the camera
     component_t *grandparent;
@@ -191,8 +191,8 @@ namespace actions {
       if (climbing_anim.anim_complete()) {
         walking_down = false;
 
-        //this mutates current_position
-        parent.set_position(
+        //this mutates current_position (a snap, the step corner isn't swept)
+        parent.snap_position(
           facing_left ? (current_position.x - 8) : (current_position.x + 8),
           current_position.y + 8
         );
@@ -230,7 +230,7 @@ namespace actions {
     //check whether the parent is facing left
     bool facing_left = parent.get_as<entity_t>().facing_left();
     //update the animation direction
-    this->get_nth_child<common::anim_t>(walking_up ? climbing_up_action : (walking_down ? climbing_down_action : walking_action)).set_flipped(
+    this->get_child(walking_up ? climbing_up_action : (walking_down ? climbing_down_action : walking_action)).set_flipped(
       //flip the active animation based on the entity direction
       facing_left
     );
@@ -253,7 +253,7 @@ namespace actions {
     }
 
     //update the current animation
-    common::component_t::update_child(walking_up ? climbing_up_action : (walking_down ? climbing_down_action : walking_action));
+    common::component_t::update_child((walking_up ? climbing_up_action : (walking_down ? climbing_down_action : walking_action)).idx);
 
     //lock the action if walking up (action can be preempted if not walking up)
     this->set_completed(!walking_up);
@@ -263,12 +263,14 @@ namespace actions {
    * Render this component
    * @param renderer the sdl renderer
    * @param camera   the current camera
+   * @param alpha    progress (0-1) between the last tick and the next
    */
   void walking_t::render(SDL_Renderer& renderer,
-                         const SDL_Rect& camera) const {
+                         const SDL_Rect& camera,
+                         float alpha) const {
     //render the correct animation
-    common::component_t::render_child(renderer,camera,
-      walking_up ? climbing_up_action : (walking_down ? climbing_down_action : walking_action));
+    common::component_t::render_child(renderer,camera,alpha,
+      (walking_up ? climbing_up_action : (walking_down ? climbing_down_action : walking_action)).idx);
   }
 
 }}}
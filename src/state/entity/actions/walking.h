@@ -31,9 +31,9 @@ namespace actions {
     bool walking_down;
 
     //anim children indices
-    size_t walking_action;
-    size_t climbing_up_action;
-    size_t climbing_down_action;
+    common::child_handle_t<common::anim_t> walking_action;
+    common::child_handle_t<common::anim_t> climbing_up_action;
+    common::child_handle_t<common::anim_t> climbing_down_action;
 
     /**
      * Load any resources for this component
@@ -75,9 +75,11 @@ namespace actions {
      * Render this component
      * @param renderer the sdl renderer
      * @param camera   the current camera
+     * @param alpha    progress (0-1) between the last tick and the next
      */
     void render(SDL_Renderer& renderer,
-                const SDL_Rect& camera) const override;
+                const SDL_Rect& camera,
+                float alpha) const override;
 
   public:
     /**
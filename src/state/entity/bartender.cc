@@ -6,7 +6,6 @@
 
 #include "bartender.h"
 #include <memory>
-#include "../../common/animation.h"
 
 namespace state {
 namespace entity {
@@ -26,9 +25,10 @@ namespace entity {
       idle_cycle_duration(0),
       rem_idle_cycles(0),
       needs_reset(false),
-      action_serve(0),
-      action_walk(0),
-      action_idle(0) {}
+      action_serve{0},
+      action_walk{0},
+      action_idle{0},
+      current_anim{0} {}
       
   /**
    * Load any resources for this component
@@ -42,26 +42,24 @@ namespace entity {
 
     //load the animation sheet
     std::shared_ptr<common::image_t> anim_sheet =
-      std::make_shared<common::image_t>(
-      renderer, this->rsrc_path("animations/bartender.png")
-    );
+      resources.textures->get(renderer, this->rsrc_path("animations/bartender.png"));
 
     //add serving anim
-    action_serve = this->add_child(
+    action_serve = this->add_child_as(
       std::make_unique<common::anim_t>(
         anim_sheet, ANIM_W, ANIM_H,
         0, 16, 3, true
       )
     );
     //add walking animation
-    action_walk = this->add_child(
+    action_walk = this->add_child_as(
       std::make_unique<common::anim_t>(
         anim_sheet, ANIM_W, ANIM_H,
         1, 7, 3, true
       )
     );
     //add idle anim
-    action_idle = this->add_child(
+    action_idle = this->add_child_as(
       std::make_unique<common::anim_t>(
         anim_sheet, ANIM_W, ANIM_H,
         2, 12, 3
@@ -69,10 +67,10 @@ namespace entity {
     );
 
     //Set the starting action
-    current_action = action_serve;
+    set_action(action_serve);
 
     //determine the duration of the idle cycle
-    idle_cycle_duration = this->get_nth_child<common::anim_t>(action_idle).get_cycle_duration();
+    idle_cycle_duration = this->get_child(action_idle).get_cycle_duration();
     rem_idle_cycles = idle_cycle_duration * IDLE_CYCLES;
 
     //load the action resources
@@ -83,21 +81,21 @@ namespace entity {
    * Update the player
    */
   void bartender_t::update(common::component_t& parent) {
-    if (this->get_nth_child<common::anim_t>(current_action).anim_complete()) {
+    if (this->get_child(current_anim).anim_complete()) {
       //update the current animation
-      if (current_action == action_serve) {
-        current_action = action_walk;
+      if (current_anim.idx == action_serve.idx) {
+        set_action(action_walk);
         //reset the animation
-        this->get_nth_child<common::anim_t>(current_action).reset_animation();
+        this->get_child(current_anim).reset_animation();
 
-      } else if (current_action == action_walk) {
-        current_action = action_idle;
+      } else if (current_anim.idx == action_walk.idx) {
+        set_action(action_idle);
         //reset the animation
-        this->get_nth_child<common::anim_t>(current_action).reset_animation();
+        this->get_child(current_anim).reset_animation();
       }
     }
 
-    if ((current_action == action_idle) && working) {
+    if ((current_anim.idx == action_idle.idx) && working) {
       rem_idle_cycles--;
       working = rem_idle_cycles > 0;
     }
@@ -107,6 +105,15 @@ namespace entity {
   }
 
 
+  /**
+   * Switch to an action
+   * @param action the action child
+   */
+  void bartender_t::set_action(common::child_handle_t<common::anim_t> action) {
+    current_anim = action;
+    current_action = action.idx;
+  }
+
   /**
    * Called when the player interacts with this component
    * @param parent the parent
@@ -118,12 +125,12 @@ namespace entity {
       //player will need to leave to trigger this again
       needs_reset = true;
       //switch to serving action
-      current_action = action_serve;
+      set_action(action_serve);
       working = true;
       rem_idle_cycles = idle_cycle_duration * IDLE_CYCLES;
 
       //reset the serving action
-      this->get_nth_child<common::anim_t>(current_action).reset_animation();
+      this->get_child(current_anim).reset_animation();
     }
   }
 
@@ -12,6 +12,7 @@
 #include "../../common/component.h"
 #include "../../common/shared_resources.h"
 #include "../../common/image.h"
+#include "../../common/animation.h"
 #include "player.h"
 #include "entity.h"
 
@@ -32,10 +33,18 @@ namespace entity {
     //whether the player needs to enter and leave the area
     bool needs_reset;
 
-    //action children indices
-    size_t action_serve;
-    size_t action_walk;
-    size_t action_idle;
+    //action children
+    common::child_handle_t<common::anim_t> action_serve;
+    common::child_handle_t<common::anim_t> action_walk;
+    common::child_handle_t<common::anim_t> action_idle;
+    //the action being played
+    common::child_handle_t<common::anim_t> current_anim;
+
+    /**
+     * Switch to an action
+     * @param action the action child
+     */
+    void set_action(common::child_handle_t<common::anim_t> action);
 
     /**
      * Load any resources for this component
@@ -20,19 +20,44 @@ namespace entity {
                                                COMPONENT_COLLIDABLE |
                                                COMPONENT_GRAVITY | flags),
       health(health),
-      attributes_idx(0),
+      attributes_idx(),
+      store(),
+      store_handle({0,0}),
       current_action(0),
       left(false) {
+    add_kind(COMPONENT_KIND_ENTITY);
     //add the entity attributes
-    attributes_idx = this->add_child(
+    attributes_idx = this->add_child_as(
       std::make_unique<entity_attributes_t>()
     );
   }
 
+  /**
+   * Destructor (releases the store entry)
+   */
+  entity_t::~entity_t() {
+    if (store) {
+      store->remove(store_handle);
+    }
+  }
+
   /**
    * Update the state
+   * @param parent the parent component
    */
   void entity_t::update(common::component_t& parent) {
+    //hand gravity to the level's motion pass (swept against the level's
+    //solids at the end of the tick, see entity_store_t::step_motion)
+    if (!store && parent.has_kind(COMPONENT_KIND_LEVEL)) {
+      store = this->get_entity_store();
+      if (store) {
+        store_handle = store->add(this->get_bounds(),
+                                  COMPONENT_COLLIDABLE | COMPONENT_GRAVITY);
+        store->set_motion_owner(store_handle, this);
+        this->remove_flags(COMPONENT_GRAVITY);
+      }
+    }
+
     //update the current action child
     common::component_t::update_child(current_action);
   }
@@ -41,12 +66,14 @@ namespace entity {
    * Render the current state
    */
   void entity_t::render(SDL_Renderer& renderer,
-                        const SDL_Rect& camera) const {
+                        const SDL_Rect& camera,
+                        float alpha) const {
     // //TEMP
     // debug_render_bounds(renderer,camera);
     //render the current action child
     common::component_t::render_child(renderer,
                                       camera,
+                                      alpha,
                                       current_action);
   }
 
@@ -79,7 +106,7 @@ namespace entity {
    * @return entity attributes
    */
   entity_attributes_t& entity_t::get_attributes() {
-    return this->get_nth_child<entity_attributes_t>(attributes_idx);
+    return this->get_child(attributes_idx);
   }
 
 }}
@@ -10,8 +10,10 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include "../../common/component.h"
+#include "../../common/entity_store.h"
 #include "entity_attributes.h"
 #include <stdint.h>
+#include <memory>
 
 namespace state {
 namespace entity {
@@ -26,7 +28,11 @@ namespace entity {
     //the health of the entity
     int health;
     //the child index of the entity attributes
-    size_t attributes_idx;
+    common::child_handle_t<entity_attributes_t> attributes_idx;
+    //the level entity store applying gravity once the entity is in a level (optional)
+    std::shared_ptr<common::entity_store_t> store;
+    //the entry in the store
+    common::entity_handle_t store_handle;
 
     /**
      * Update the state
@@ -37,7 +43,8 @@ namespace entity {
      * Render the current state
      */
     void render(SDL_Renderer& renderer,
-                const SDL_Rect& camera) const override;
+                const SDL_Rect& camera,
+                float alpha) const override;
 
   protected:
     //the current action of the entity
@@ -46,6 +53,10 @@ namespace entity {
     bool left;
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_ENTITY;
+    typedef entity_t component_kind_owner_t;
+
     /**
      * Constructor
      * @param position starting position
@@ -56,6 +67,11 @@ namespace entity {
     entity_t(const entity_t&) = delete;
     entity_t& operator=(const entity_t&) = delete;
 
+    /**
+     * Destructor (releases the store entry)
+     */
+    ~entity_t();
+
     /**
      * Whether the entity is facing left
      * @return the orientation
@@ -15,7 +15,9 @@ namespace entity {
    * @param health starting health for the entity
    */
   entity_attributes_t::entity_attributes_t()
-    : common::component_t({0,0,0,0}, 0) {}
+    : common::component_t({0,0,0,0}, 0) {
+    add_kind(COMPONENT_KIND_ATTRIBUTES);
+  }
 
   /**
    * Update these attributes based on others
@@ -34,6 +34,10 @@ namespace entity {
               common::shared_resources& resources) override {}
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_ATTRIBUTES;
+    typedef entity_attributes_t component_kind_owner_t;
+
     /**
      * Constructor
      * @param position starting position
@@ -22,7 +22,9 @@ namespace entity {
       next_action(-1),
       next_direction(false),
       action_idle(0),
-      action_walking(0) {}
+      action_walking(0) {
+    add_kind(COMPONENT_KIND_PLAYER);
+  }
 
   /**
    * Load any resources for this component
@@ -54,6 +54,10 @@ namespace entity {
                       const SDL_Event& e) override;
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_PLAYER;
+    typedef player_t component_kind_owner_t;
+
     /**
      * Constructor
      * @param position starting position for the player
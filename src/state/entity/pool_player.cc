@@ -5,7 +5,6 @@
  */
 
 #include "pool_player.h"
-#include "../../common/animation.h"
 
 namespace state {
 namespace entity {
@@ -22,9 +21,10 @@ namespace entity {
     : entity_t({x,y,ANIM_W,ANIM_H},100),
       idle_updates_rem(0),
       idle_updates_total(0),
-      action_shooting(0),
-      action_waiting(0),
-      action_prepare(0) {}
+      action_shooting{0},
+      action_waiting{0},
+      action_prepare{0},
+      current_anim{0} {}
 
   /**
    * Load any resources for this component
@@ -36,12 +36,10 @@ namespace entity {
                            const common::component_t& parent,
                            common::shared_resources& resources) {
     std::shared_ptr<common::image_t> anim_sheet =
-      std::make_shared<common::image_t>(
-      renderer, this->rsrc_path("animations/pool_player.png")
-    );
+      resources.textures->get(renderer, this->rsrc_path("animations/pool_player.png"));
 
     //add shooting anim
-    action_shooting = this->add_child(
+    action_shooting = this->add_child_as(
       //shooting anim
       std::make_unique<common::anim_t>(
         anim_sheet, ANIM_W, ANIM_H,
@@ -49,7 +47,7 @@ namespace entity {
       )
     );
     //add idle anim
-    action_waiting = this->add_child(
+    action_waiting = this->add_child_as(
       //waiting anim
       std::make_unique<common::anim_t>(
         anim_sheet, ANIM_W, ANIM_H,
@@ -57,7 +55,7 @@ namespace entity {
       )
     );
     //add prep anim
-    action_prepare = this->add_child(
+    action_prepare = this->add_child_as(
       //prep anim
       std::make_unique<common::anim_t>(
         anim_sheet, ANIM_W, ANIM_H,
@@ -66,13 +64,13 @@ namespace entity {
     );
 
     //set the current action
-    current_action = action_waiting;
+    set_action(action_waiting);
 
     //load the action resources
     component_t::load_children(renderer,resources);
 
     //determine the total cycles per idle
-    idle_updates_total = this->get_nth_child<common::anim_t>(action_waiting).get_cycle_duration() * 3;
+    idle_updates_total = this->get_child(action_waiting).get_cycle_duration() * 3;
     idle_updates_rem = idle_updates_total;
   }
 
@@ -80,29 +78,38 @@ namespace entity {
    * Update the player
    */
   void pool_player_t::update(common::component_t& parent) {
-    if (current_action == action_waiting) {
+    if (current_anim.idx == action_waiting.idx) {
       if (idle_updates_rem > 0) {
         idle_updates_rem--;
       } else {
-        current_action = action_prepare;
-        this->get_nth_child<common::anim_t>(current_action).reset_animation();
+        set_action(action_prepare);
+        this->get_child(current_anim).reset_animation();
       }
 
-    } else if (this->get_nth_child<common::anim_t>(current_action).anim_complete()) {
+    } else if (this->get_child(current_anim).anim_complete()) {
 
-      if (current_action == action_shooting) {
-        current_action = action_waiting;
+      if (current_anim.idx == action_shooting.idx) {
+        set_action(action_waiting);
         idle_updates_rem = idle_updates_total;
 
-      } else if (current_action == action_prepare) {
-        current_action = action_shooting;
+      } else if (current_anim.idx == action_prepare.idx) {
+        set_action(action_shooting);
       }
 
-      this->get_nth_child<common::anim_t>(current_action).reset_animation();
+      this->get_child(current_anim).reset_animation();
     }
 
     //update current
     common::component_t::update_child(current_action);
   }
 
+  /**
+   * Switch to an action
+   * @param action the action child
+   */
+  void pool_player_t::set_action(common::child_handle_t<common::anim_t> action) {
+    current_anim = action;
+    current_action = action.idx;
+  }
+
 }}
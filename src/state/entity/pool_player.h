@@ -11,6 +11,7 @@
 #include <SDL2/SDL_image.h>
 #include "../../common/component.h"
 #include "../../common/shared_resources.h"
+#include "../../common/animation.h"
 #include "entity.h"
 
 namespace state {
@@ -26,10 +27,18 @@ namespace entity {
     //number of idle cycles remaining
     int idle_updates_total;
 
-    //the action children indices
-    size_t action_shooting;
-    size_t action_waiting;
-    size_t action_prepare;
+    //the action children
+    common::child_handle_t<common::anim_t> action_shooting;
+    common::child_handle_t<common::anim_t> action_waiting;
+    common::child_handle_t<common::anim_t> action_prepare;
+    //the action being played
+    common::child_handle_t<common::anim_t> current_anim;
+
+    /**
+     * Switch to an action
+     * @param action the action child
+     */
+    void set_action(common::child_handle_t<common::anim_t> action);
 
     /**
      * Load any resources for this component
@@ -17,7 +17,9 @@ namespace state {
    */
   level_manager_t::level_manager_t()
     : common::component_t({0,0,0,0},COMPONENT_ALWAYS_VISIBLE),
-      current_map_location(0) {}
+      current_map_location(0) {
+    add_kind(COMPONENT_KIND_MANAGER);
+  }
 
     /**
      * Load any resources for this component
@@ -48,9 +50,10 @@ namespace state {
    * Render the current state
    */
   void level_manager_t::render(SDL_Renderer& renderer,
-                               const SDL_Rect& camera) const {
+                               const SDL_Rect& camera,
+                               float alpha) const {
     //render the active region
-    common::component_t::render_child(renderer,camera,current_map_location);
+    common::component_t::render_child(renderer,camera,alpha,current_map_location);
     common::component_t::render_fg_child(renderer,camera,current_map_location);
   }
 
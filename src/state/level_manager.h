@@ -44,7 +44,8 @@ namespace state {
      * Render the current state
      */
     void render(SDL_Renderer& renderer,
-                const SDL_Rect& camera) const override;
+                const SDL_Rect& camera,
+                float alpha) const override;
 
     /**
      * Handle an sdl event
@@ -55,6 +56,10 @@ namespace state {
                       const SDL_Event& e) override;
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_MANAGER;
+    typedef level_manager_t component_kind_owner_t;
+
     /**
      * Manage different levels
      */
@@ -34,9 +34,11 @@ namespace levels {
   void dive_bar_t::load(SDL_Renderer& renderer,
                         const common::component_t& parent,
                         common::shared_resources& resources) {
+    //everything created while loading lives in the level arena
+    common::arena_scope_t arena_scope(this->get_arena());
 
     //add background map layers
-    this->add_child(std::make_unique<tilemap::tilemap_t>(
+    size_t bg_idx = this->add_child(std::make_unique<tilemap::tilemap_t>(
       this->rsrc_path("maps/bar.txt"),
       resources.divebar_tileset,
       std::vector<int>{0,1,2},
@@ -77,6 +79,10 @@ namespace levels {
       1, 144, 32
     ));
 
+    //map layers draw behind and in front of everything else
+    this->get_nth_child(bg_idx).set_render_layer(RENDER_LAYER_BG);
+    this->get_nth_child(fg_idx).set_render_layer(RENDER_LAYER_FG);
+
     //load children
     component_t::load_children(renderer,resources);
 
@@ -90,6 +96,9 @@ namespace levels {
    * Update the state
    */
   void dive_bar_t::update(common::component_t& parent) {
+    //keep the last camera position for interpolation
+    this->store_camera();
+
     //get the player position
     const SDL_Rect& player_bounds = this->get_nth_child(player_idx).get_bounds();
 
@@ -98,6 +107,9 @@ namespace levels {
 
     //update components in level
     component_t::update(parent);
+
+    //linear passes over the entity store
+    this->update_systems();
   }
 
 
@@ -31,8 +31,11 @@ namespace levels {
   void exterior_t::load(SDL_Renderer& renderer,
                         const common::component_t& parent,
                         common::shared_resources& resources) {
+    //everything created while loading lives in the level arena
+    common::arena_scope_t arena_scope(this->get_arena());
+
     //add background map layers
-    this->add_child(std::make_unique<tilemap::tilemap_t>(
+    size_t bg_idx = this->add_child(std::make_unique<tilemap::tilemap_t>(
       this->rsrc_path("maps/exterior.txt"),
       resources.exterior_tileset,
       std::vector<int>{0,1},
@@ -58,6 +61,10 @@ namespace levels {
       0, 272, 80
     ));
 
+    //map layers draw behind and in front of everything else
+    this->get_nth_child(bg_idx).set_render_layer(RENDER_LAYER_BG);
+    this->get_nth_child(fg_idx).set_render_layer(RENDER_LAYER_FG);
+
     //load children
     component_t::load_children(renderer,resources);
 
@@ -71,6 +78,9 @@ namespace levels {
    * Update the state
    */
   void exterior_t::update(common::component_t& parent) {
+    //keep the last camera position for interpolation
+    this->store_camera();
+
     //get the player position
     const SDL_Rect& player_bounds = this->get_nth_child(player_idx).get_bounds();
 
@@ -79,6 +89,9 @@ namespace levels {
 
     //update components in level
     component_t::update(parent);
+
+    //linear passes over the entity store
+    this->update_systems();
   }
 
   /**
@@ -6,7 +6,9 @@
 
 #include "level.h"
 #include "../../window/window.h"
+#include "../../common/rect.h"
 #include <algorithm>
+#include <cstdlib>
 
 namespace state {
 namespace levels {
@@ -16,16 +18,74 @@ namespace levels {
    */
   level_t::level_t()
     : common::component_t({0,0,0,0}, COMPONENT_ALWAYS_VISIBLE),
+      arena(),
       level_camera({0,0,window::LOGICAL_W_PX,window::LOGICAL_H_PX}),
+      prev_camera(level_camera),
       max_width(0),
-      max_height(0) {}
+      max_height(0),
+      entity_store(std::make_shared<common::entity_store_t>()) {
+    add_kind(COMPONENT_KIND_LEVEL);
+    //levels may contain many solid components
+    this->enable_broadphase(LEVEL_BROADPHASE_CELL);
+    //interactive components are indexed as they are added
+    this->enable_interactions(LEVEL_INTERACTION_CELL);
+  }
+
+  /**
+   * Destructor, tears down the tree then frees its arena in one go
+   */
+  level_t::~level_t() {
+    //children live in the arena, destroy them before it goes
+    component_t::clear_children();
+  }
 
   /**
    * Render the current state
    */
-  void level_t::render(SDL_Renderer& renderer, const SDL_Rect&) const {
+  void level_t::render(SDL_Renderer& renderer,
+                       const SDL_Rect&,
+                       float alpha) const {
+    SDL_Rect camera = level_camera;
+    int dx = level_camera.x - prev_camera.x;
+    int dy = level_camera.y - prev_camera.y;
+
+    //interpolate the camera unless it jumped
+    if ((std::abs(dx) <= INTERPOLATION_SNAP_PX) &&
+        (std::abs(dy) <= INTERPOLATION_SNAP_PX)) {
+      camera.x = prev_camera.x + (int)(dx * alpha);
+      camera.y = prev_camera.y + (int)(dy * alpha);
+    }
+
     //render everything in the level using this camera
-    component_t::render(renderer,level_camera);
+    component_t::render(renderer,camera,alpha);
+  }
+
+  /**
+   * Save the camera position at the start of a tick
+   * (used to interpolate the camera when rendering)
+   */
+  void level_t::store_camera() {
+    prev_camera = level_camera;
+  }
+
+  /**
+   * Run the entity store systems (call at the end of the level update)
+   */
+  void level_t::update_systems() {
+    entity_store->step_motion(*this);
+    entity_store->advance_animations();
+
+    //cull for every camera rendered before the next tick (interpolated between the two)
+    entity_store->cull(common::rect_expand(common::rect_union(prev_camera, level_camera),
+                                           INTERPOLATION_SNAP_PX));
+  }
+
+  /**
+   * Get the entity store for this level
+   * @return the store
+   */
+  std::shared_ptr<common::entity_store_t> level_t::get_entity_store() {
+    return entity_store;
   }
 
   /**
@@ -8,22 +8,36 @@
 #define _DIVEBAR_STATE_LEVELS_LEVEL_H
 
 #include <SDL2/SDL.h>
+#include <memory>
 #include "../../common/component.h"
+#include "../../common/entity_store.h"
+#include "../../common/arena.h"
 #include "../entity/entity_attributes.h"
 
 namespace state {
 namespace levels {
 
+  //cell size for the level collision broadphase (px)
+  #define LEVEL_BROADPHASE_CELL 32
+  //cell size for the level interaction index (px)
+  #define LEVEL_INTERACTION_CELL 64
+
   /*
    * Defines a map with a camera specific to the map
    */
   class level_t : public common::component_t {
   private:
+    //owns the memory of the components loaded into this level
+    common::arena_t arena;
     //level maintains its own camera
     SDL_Rect level_camera;
+    //the camera at the start of the current tick
+    SDL_Rect prev_camera;
     //the max width and max height of the level
     int max_width;
     int max_height;
+    //structure of arrays data for entities in this level (shared with their components)
+    std::shared_ptr<common::entity_store_t> entity_store;
 
   protected:
 
@@ -31,7 +45,8 @@ namespace levels {
      * Render the current state
      */
     void render(SDL_Renderer& renderer,
-                const SDL_Rect& camera) const override;
+                const SDL_Rect& camera,
+                float alpha) const override;
 
     /**
      * Set the max dimensions of the level
@@ -40,7 +55,29 @@ namespace levels {
      */
     void set_max_bounds(int max_width, int max_height);
 
+    /**
+     * Save the camera position at the start of a tick
+     * (used to interpolate the camera when rendering)
+     */
+    void store_camera();
+
+    /**
+     * Run the entity store systems (call at the end of the level update)
+     */
+    void update_systems();
+
+    /**
+     * Get the arena for components loaded into this level
+     * (use with common::arena_scope_t while loading)
+     * @return the arena
+     */
+    common::arena_t& get_arena() { return arena; }
+
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_LEVEL;
+    typedef level_t component_kind_owner_t;
+
     /**
      * Default constructor
      */
@@ -48,6 +85,11 @@ namespace levels {
     level_t(const level_t&) = delete;
     level_t& operator=(const level_t&) = delete;
 
+    /**
+     * Destructor, tears down the tree then frees its arena in one go
+     */
+    virtual ~level_t();
+
     /**
      * Center the camera at some position
      * @param x position x
@@ -55,6 +97,12 @@ namespace levels {
      */
     void center_camera(int x, int y);
 
+    /**
+     * Get the entity store for this level
+     * @return the store
+     */
+    std::shared_ptr<common::entity_store_t> get_entity_store() override;
+
     /**
      * Move the player to some position in this level
      * @param x new player position x
@@ -8,6 +8,7 @@
 #include "level_manager.h"
 #include "../window/window.h"
 #include "../common/shared_resources.h"
+#include "../common/render_queue.h"
 #include <memory>
 
 namespace state {
@@ -16,9 +17,12 @@ namespace state {
    * Constructor
    */
   manager_t::manager_t(SDL_Renderer& renderer, const std::string& resource_dir)
-    : component_t({0,0,0,0},COMPONENT_ALWAYS_VISIBLE,SDLK_e,resource_dir),
+    : component_t({0,0,0,0},COMPONENT_ALWAYS_VISIBLE,SDLK_e,
+                  common::resource_root_t::intern(resource_dir)),
       current_state(0),
-      camera({0,0,window::LOGICAL_W_PX,window::LOGICAL_H_PX}) {
+      camera({0,0,window::LOGICAL_W_PX,window::LOGICAL_H_PX}),
+      assets(std::make_shared<common::asset_loader_t>()),
+      textures(std::make_shared<common::texture_cache_t>(assets)) {
     //load child states
 
     //add the title manager
@@ -29,7 +33,7 @@ namespace state {
 
     //create shared resources
     std::shared_ptr<common::shared_resources> shared_resources =
-      std::make_shared<common::shared_resources>(renderer, resource_dir);
+      std::make_shared<common::shared_resources>(renderer, resource_dir, textures);
 
     //load resources for children
     component_t::load_children(renderer,*shared_resources);
@@ -42,6 +46,9 @@ namespace state {
   void manager_t::update_manager() {
     //update the current component
     common::component_t::update_child(current_state);
+
+    //drop anything marked for removal during the tick
+    common::component_t::remove_marked_children();
   }
 
   /**
@@ -55,10 +62,23 @@ namespace state {
 
   /**
    * Render the current state
+   * @param renderer the sdl renderer
+   * @param alpha    progress (0-1) between the last tick and the next
    */
-  void manager_t::render_manager(SDL_Renderer& renderer) const {
+  void manager_t::render_manager(SDL_Renderer& renderer, float alpha) const {
+    //record the frame, sorted and drawn when the queue goes out of scope
+    common::render_queue_t queue(renderer);
     //render the active state
-    common::component_t::render_child(renderer,camera,current_state);
+    common::component_t::render_child(renderer,camera,alpha,current_state);
+  }
+
+  /**
+   * Create textures for a few images loaded in the background and
+   * drop unused ones over budget (call once per frame before rendering)
+   */
+  void manager_t::upload_assets() {
+    assets->upload_ready();
+    textures->trim();
   }
 
   /**
@@ -28,6 +28,10 @@ namespace state {
     size_t current_state;
     //the camera
     SDL_Rect camera;
+    //decodes images in the background for every level
+    std::shared_ptr<common::asset_loader_t> assets;
+    //shares loaded images between components
+    std::shared_ptr<common::texture_cache_t> textures;
 
     //unused (no parent)
     void load(SDL_Renderer&,
@@ -63,8 +67,16 @@ namespace state {
 
     /**
      * Render the current state
+     * @param renderer the sdl renderer
+     * @param alpha    progress (0-1) between the last tick and the next
      */
-    void render_manager(SDL_Renderer& renderer) const;
+    void render_manager(SDL_Renderer& renderer, float alpha) const;
+
+    /**
+     * Create textures for a few images loaded in the background and
+     * drop unused ones over budget (call once per frame before rendering)
+     */
+    void upload_assets();
 
     /**
      * Set the current state
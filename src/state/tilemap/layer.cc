@@ -7,56 +7,13 @@
 #include "layer.h"
 #include "../../common/launch_exception.h"
 #include <utility>
-#include "virtual_tile.h"
+#include "map_document.h"
+#include "../../common/rect.h"
+#include "../../common/render_queue.h"
 
 namespace state {
 namespace tilemap {
 
-  #define COMMA ','
-  #define SPACE ' '
-  #define LAYER "layer"
-  #define TILE_WIDTH "tilewidth"
-  #define TILES_HIGH "tileshigh"
-
-  /**
-   * Parse a labeled number
-   * @param  line the line ('label value')
-   * @return      the parsed number (or throws)
-   */
-  int parse_labeled_number(const std::string& line) {
-    //parse tile dimension
-    std::stringstream s_stream(line);
-
-    bool first = true;
-
-    //get each value
-    while (s_stream.good()) {
-      std::string substr;
-      std::getline(s_stream, substr, SPACE);
-
-      if (!first) {
-        try {
-          return std::stoi(substr);
-        } catch (...) {
-          throw common::launch_exception("failed to parse number from line in map file: " + line);
-        }
-      }
-      first = false;
-    }
-    throw common::launch_exception("failed to parse number from line in map file: " + line);
-    return 0;
-  }
-
-  /**
-   * Check if a string starts with some prefix
-   * @param  str    the string
-   * @param  prefix the prefix
-   * @return        whether str starts with prefix
-   */
-  bool startswith(const std::string& str, const std::string& prefix) {
-    return str.rfind(prefix, 0) == 0;
-  }
-
   /**
    * Constructor
    * @param path the path to the layer file
@@ -76,23 +33,18 @@ namespace tilemap {
       path(path),
       tileset(tileset),
       idx(idx),
-      contents(),
-      tile_dim(8) {}
-
-  /**
-   * Check if a position is within the bounds of the layer
-   * @param  x position x
-   * @param  y position y
-   * @return   whether this point is in bounds
-   */
-  bool layer_t::in_bounds(int x, int y) const {
-    int idx_x = x / tile_dim;
-    int idx_y = y / tile_dim;
-
-    //check bounds and get the type of the tile
-    return (idx_x >= 0) && (idx_y >= 0) &&
-           (idx_y < (int)this->contents.size()) &&
-           (idx_x < (int)this->contents.at(idx_y).size());
+      map(),
+      tiles(nullptr),
+      width(0),
+      height(0),
+      tile_dim(8),
+      chunks(),
+      chunks_wide(0),
+      chunks_high(0),
+      chunked(false),
+      solid_mask(),
+      mask_row_words(0) {
+    add_kind(COMPONENT_KIND_LAYER);
   }
 
   /**
@@ -102,100 +54,103 @@ namespace tilemap {
    */
   bool layer_t::collides_with(const component_t& other) const {
     //optimization: only check for solid layers
-    if (this->is_solid()) {
-      const SDL_Rect& other_bounds = other.get_bounds();
-
-      //create a virtual tile to compare with the other body
-      virtual_tile_t current_tile(tile_dim);
-
-      //generate positions that might intersect
-      for (int i=(other_bounds.x - tile_dim); i<((other_bounds.x + other_bounds.w) + tile_dim); i+=(tile_dim / 2)) {
-        for (int j=(other_bounds.y - tile_dim); j<((other_bounds.y + other_bounds.h) + tile_dim); j+=(tile_dim / 2)) {
-          //check if the generated position is in bounds
-          if (in_bounds(i,j)) {
-            //determine indices of tile
-            int idx_x = i / tile_dim;
-            int idx_y = j / tile_dim;
-
-            //set position
-            current_tile.move_to(idx_x * tile_dim, idx_y * tile_dim);
-
-            //check if solid and collided
-            if ((this->contents.at(idx_y).at(idx_x) >= 0) &&
-                other.collides_with(current_tile)) {
-              return true;
-            }
-          }
+    if (!this->is_solid() || !other.is_collidable() || solid_mask.empty()) {
+      return false;
+    }
+
+    const SDL_Rect& other_bounds = other.get_bounds();
+    if (common::rect_empty(other_bounds)) {
+      return false;
+    }
+
+    //the range of tiles covered by the other body (clamped to the layer)
+    common::cell_range_t tiles_hit =
+      common::clamp_cells(common::rect_cells(other_bounds, tile_dim), width, height);
+    if (tiles_hit.empty()) {
+      return false;
+    }
+
+    int word_start = tiles_hit.col_start / 64;
+    int word_end = tiles_hit.col_end / 64;
+
+    //bits covered in the first and last word of each row
+    uint64_t first_mask = ~(uint64_t)0 << (tiles_hit.col_start % 64);
+    uint64_t last_mask = ~(uint64_t)0 >> (63 - (tiles_hit.col_end % 64));
+
+    for (int i=tiles_hit.row_start; i<=tiles_hit.row_end; i++) {
+      const uint64_t* row = solid_mask.data() + (i * mask_row_words);
+
+      for (int w=word_start; w<=word_end; w++) {
+        uint64_t bits = row[w];
+        if (w == word_start) {
+          bits &= first_mask;
+        }
+        if (w == word_end) {
+          bits &= last_mask;
+        }
+        if (bits) {
+          return true;
         }
       }
     }
 
-    //didn't collide or not a solid layer
+    //didn't collide
     return false;
   }
 
   /**
-   * Check to see if the map is solid at this position
-   * @param  x position x
-   * @param  y position y
-   * @return   whether this position is solid
+   * Collect the solid tiles of this layer within an area
+   * @param area   the area to collect from
+   * @param solids the tile rects (appended)
    */
-  bool layer_t::solid_at(int x, int y) const {
-    return in_bounds(x,y) &&
-           (this->contents.at(y / tile_dim).at(x / tile_dim) >= 0);
-  }
+  void layer_t::solid_rects(const SDL_Rect& area,
+                            std::vector<SDL_Rect>& solids) const {
+    if (!this->is_solid() || solid_mask.empty() || common::rect_empty(area)) {
+      return;
+    }
 
-  /**
-   * Parse map contents into buffer
-   * @param file the file
-   */
-  void layer_t::parse_map_lines(std::ifstream& file, int max_height) {
-    std::string line;
-    int x = 0;
-    int y = 0;
-
-    while (std::getline(file, line)) {
-      //check if the section end reached
-      if (line.empty()) {
-        return;
-      }
+    //the range of tiles covered by the area (clamped to the layer)
+    common::cell_range_t covered =
+      common::clamp_cells(common::rect_cells(area, tile_dim), width, height);
 
-      if (y >= max_height) {
-        return;
+    for (int i=covered.row_start; i<=covered.row_end; i++) {
+      const uint64_t* row = solid_mask.data() + (i * mask_row_words);
+
+      for (int j=covered.col_start; j<=covered.col_end; j++) {
+        if (row[j / 64] & ((uint64_t)1 << (j % 64))) {
+          solids.push_back({j * tile_dim, i * tile_dim, tile_dim, tile_dim});
+        }
       }
+    }
+  }
 
-      //split line by commas
-      this->contents.emplace_back();
-      std::stringstream s_stream(line);
-
-      //get each value
-      while (s_stream.good()) {
-         std::string substr;
-         std::getline(s_stream, substr, COMMA);
-
-         if (!substr.empty()) {
-           //attempt to parse value
-           try {
-             int type = std::stoi(substr);
-
-             if (type != -1) {
-               //add the tile to the map contents
-               this->contents.back().push_back(type);
-             } else {
-               this->contents.back().push_back(-1);
-             }
-
-           } catch (...) {
-             throw common::launch_exception("failed to read from map file: " +
-              path + ", layer " + std::to_string(idx));
-           }
-           x++;
-         }
+  /**
+   * Build the solidity bitmask (one bit per tile)
+   */
+  void layer_t::build_solid_mask() {
+    mask_row_words = (width + 63) / 64;
+    solid_mask.assign(mask_row_words * height, 0);
+
+    for (int i=0; i<height; i++) {
+      for (int j=0; j<width; j++) {
+        if (tile_at(j,i) >= 0) {
+          solid_mask[(i * mask_row_words) + (j / 64)] |= (uint64_t)1 << (j % 64);
+        }
       }
-      y++;
     }
   }
 
+  /**
+   * Check to see if the map is solid at this position
+   * @param  x position x
+   * @param  y position y
+   * @return   whether this position is solid
+   */
+  bool layer_t::solid_at(int x, int y) const {
+    return in_bounds(x,y) &&
+           (tile_at(x / tile_dim, y / tile_dim) >= 0);
+  }
+
   /**
    * Load any resources for this component
    * @param renderer the sdl renderer for loading images
@@ -205,56 +160,39 @@ namespace tilemap {
   void layer_t::load(SDL_Renderer& renderer,
                      const common::component_t& parent,
                      common::shared_resources& resources) {
-    //clear any existing contents
-    contents.clear();
-
-    int layer = -1; //the current layer
-    int max_height = 0; //the height to parse for any given layer
-    std::string line; //the line read from the file
-
-    try {
-      std::ifstream layer_file(path);
-
-      while (std::getline(layer_file, line)) {
-        if (!line.empty()) {
-          if (startswith(line,TILES_HIGH)) {
-            max_height = parse_labeled_number(line);
-
-          } else if (startswith(line,TILE_WIDTH)) {
-            this->tile_dim = parse_labeled_number(line);
-
-          } else if (startswith(line,LAYER)) {
-            //get the current layer number
-            layer = parse_labeled_number(line);
-            if (layer == (int)this->idx) {
-              //parse this layer
-              parse_map_lines(layer_file,max_height);
-              return; //done
-            }
-          }
-        }
-      }
-
-    } catch (...) {
-      throw common::launch_exception("failed to read from map file: " +
-        path + ", layer " + std::to_string(idx));
+    //view into the (shared) parsed map file
+    map = map_document_t::get(path,resources);
+    layer_tiles_t& contents = map->get_layer(idx);
+    tiles = contents.tiles;
+    width = contents.width;
+    height = contents.height;
+    tile_dim = map->get_tile_dim();
+
+    //precompute solidity for collision checks
+    if (this->is_solid()) {
+      build_solid_mask();
     }
 
-    if (contents.empty()) {
-      throw common::launch_exception("failed to read from map file: " +
-        path + ", layer " + std::to_string(idx) + " (nothing loaded)");
-    }
+    //split the layer into chunks (rendered when first drawn, so the tileset can finish loading)
+    build_chunks(renderer);
 
     component_t::load_children(renderer,resources);
   }
 
   /**
-   * Render the current state
+   * Render a range of tiles
+   * @param renderer  the sdl renderer
+   * @param origin_x  the position (px) that maps to 0 on the render target
+   * @param origin_y  the position (px) that maps to 0 on the render target
+   * @param row_start the first row
+   * @param row_end   the row to stop at
+   * @param col_start the first column
+   * @param col_end   the column to stop at
    */
-  void layer_t::render(SDL_Renderer& renderer,
-                       const SDL_Rect& camera) const {
-    //create a virtual tile to compare with the other body
-    virtual_tile_t current_tile(tile_dim);
+  void layer_t::render_tiles(SDL_Renderer& renderer,
+                             int origin_x, int origin_y,
+                             int row_start, int row_end,
+                             int col_start, int col_end) const {
     SDL_Rect sample_bounds = {0,0,tile_dim,tile_dim};
     SDL_Rect render_bounds = {0,0,tile_dim,tile_dim};
 
@@ -262,35 +200,174 @@ namespace tilemap {
     const SDL_Rect& tileset_dim = tileset->default_bounds();
     int tiles_per_row = tileset_dim.w / tile_dim;
 
+    row_start = std::max(row_start, 0);
+    row_end = std::min(row_end, height);
+    col_start = std::max(col_start, 0);
+    col_end = std::min(col_end, width);
+
     //render tiles in layer
-    for (size_t i=0; i<contents.size(); i++) {
-      for (size_t j=0; j<contents.at(i).size(); j++) {
+    for (int i=row_start; i<row_end; i++) {
+      const int16_t* row = tiles + (i * width);
+
+      for (int j=col_start; j<col_end; j++) {
         //the index of the current tile
-        int tile_idx = contents.at(i).at(j);
+        int tile_idx = row[j];
 
         //check if tile visible at all
         if (tile_idx > -1) {
-          //set position of collision body
-          current_tile.move_to(j * tile_dim, i * tile_dim);
-
           //set the sample region within the tileset
           sample_bounds.x = tile_dim * (tile_idx % tiles_per_row);
           sample_bounds.y = tile_dim * (tile_idx / tiles_per_row);
 
           //set the position to render the tileset sample
-          render_bounds.x = (tile_dim * j) - camera.x;
-          render_bounds.y = (tile_dim * i) - camera.y;
-
-          //check if visible to camera
-          if (current_tile.is_visible(camera)) {
-            //render using tileset
-            this->tileset->render_copy(
-              renderer,
-              sample_bounds,
-              render_bounds
-            );
-          }
+          render_bounds.x = (tile_dim * j) - origin_x;
+          render_bounds.y = (tile_dim * i) - origin_y;
+
+          //render using tileset
+          this->tileset->render_copy(
+            renderer,
+            sample_bounds,
+            render_bounds
+          );
+        }
+      }
+    }
+  }
+
+  /**
+   * Split the layer into chunks (each is rendered when first drawn)
+   * @param renderer the sdl renderer
+   */
+  void layer_t::build_chunks(SDL_Renderer& renderer) {
+    chunks.clear();
+    chunks_wide = (width + LAYER_CHUNK_TILES - 1) / LAYER_CHUNK_TILES;
+    chunks_high = (height + LAYER_CHUNK_TILES - 1) / LAYER_CHUNK_TILES;
+
+    //renderer can't draw to textures, render tiles directly
+    chunked = (SDL_RenderTargetSupported(&renderer) == SDL_TRUE);
+    if (chunked) {
+      chunks.resize(chunks_wide * chunks_high);
+    }
+  }
+
+  /**
+   * Render the tiles in a chunk to the chunk texture
+   * @param  renderer the sdl renderer
+   * @param  chunk    the index of the chunk
+   * @return          whether the chunk could be rendered
+   */
+  bool layer_t::bake_chunk(SDL_Renderer& renderer, size_t chunk) const {
+    int chunk_px = LAYER_CHUNK_TILES * tile_dim;
+    int chunk_x = (chunk % chunks_wide) * chunk_px;
+    int chunk_y = (chunk / chunks_wide) * chunk_px;
+
+    if (!chunks.at(chunk).image) {
+      //edge chunks only cover the rest of the map
+      int w = std::min(chunk_px, get_layer_width() - chunk_x);
+      int h = std::min(chunk_px, get_layer_height() - chunk_y);
+
+      SDL_Texture* texture = SDL_CreateTexture(&renderer,
+                                               SDL_PIXELFORMAT_RGBA8888,
+                                               SDL_TEXTUREACCESS_TARGET,
+                                               w, h);
+      if (texture == NULL) {
+        return false;
+      }
+      //keep tileset transparency
+      SDL_SetTextureBlendMode(texture,SDL_BLENDMODE_BLEND);
+      chunks.at(chunk).image = std::make_unique<common::image_t>(texture, w, h);
+    }
+
+    //draw to the chunk
+    SDL_Texture* target = SDL_GetRenderTarget(&renderer);
+    if (SDL_SetRenderTarget(&renderer,chunks.at(chunk).image->get_texture()) != 0) {
+      return false;
+    }
+
+    SDL_SetRenderDrawColor(&renderer,0,0,0,0);
+    SDL_RenderClear(&renderer);
+
+    int tile_x = (chunk % chunks_wide) * LAYER_CHUNK_TILES;
+    int tile_y = (chunk / chunks_wide) * LAYER_CHUNK_TILES;
+    {
+      //tiles get a queue of their own (the frame's queue draws to the old target later)
+      common::render_queue_t chunk_queue(renderer);
+      render_tiles(renderer, chunk_x, chunk_y,
+                   tile_y, tile_y + LAYER_CHUNK_TILES,
+                   tile_x, tile_x + LAYER_CHUNK_TILES);
+    }
+
+    //restore the previous target
+    SDL_SetRenderTarget(&renderer,target);
+    chunks.at(chunk).dirty = false;
+    return true;
+  }
+
+  /**
+   * Change a tile (the chunk containing it is re-rendered when next drawn)
+   * @param x    tile column
+   * @param y    tile row
+   * @param tile the new tile index (-1 for none)
+   */
+  void layer_t::set_tile(int x, int y, int tile) {
+    if (((unsigned)x >= (unsigned)width) || ((unsigned)y >= (unsigned)height)) {
+      throw common::launch_exception("tile out of range in layer " + std::to_string(idx));
+    }
+    tiles[(y * width) + x] = (int16_t)tile;
+
+    if (!solid_mask.empty()) {
+      uint64_t bit = (uint64_t)1 << (x % 64);
+      uint64_t& word = solid_mask[(y * mask_row_words) + (x / 64)];
+      word = (tile >= 0) ? (word | bit) : (word & ~bit);
+    }
+
+    if (chunked) {
+      chunks.at(((y / LAYER_CHUNK_TILES) * chunks_wide) + (x / LAYER_CHUNK_TILES)).dirty = true;
+    }
+  }
+
+  /**
+   * Render the current state
+   */
+  void layer_t::render(SDL_Renderer& renderer,
+                       const SDL_Rect& camera,
+                       float) const {
+    if (!chunked) {
+      //only the tiles the camera can see
+      common::cell_range_t in_view = common::rect_cells(camera, tile_dim);
+      render_tiles(renderer, camera.x, camera.y,
+                   in_view.row_start, in_view.row_end + 1,
+                   in_view.col_start, in_view.col_end + 1);
+      return;
+    }
+
+    //only the chunks the camera can see
+    int chunk_px = LAYER_CHUNK_TILES * tile_dim;
+    common::cell_range_t in_view =
+      common::clamp_cells(common::rect_cells(camera, chunk_px), chunks_wide, chunks_high);
+
+    for (int i=in_view.row_start; i<=in_view.row_end; i++) {
+      for (int j=in_view.col_start; j<=in_view.col_end; j++) {
+        size_t chunk = (i * chunks_wide) + j;
+
+        //tiles changed since last drawn
+        if (chunks[chunk].dirty && !bake_chunk(renderer,chunk)) {
+          //no chunk texture, draw its tiles directly
+          int tile_x = j * LAYER_CHUNK_TILES;
+          int tile_y = i * LAYER_CHUNK_TILES;
+          render_tiles(renderer, camera.x, camera.y,
+                       tile_y, tile_y + LAYER_CHUNK_TILES,
+                       tile_x, tile_x + LAYER_CHUNK_TILES);
+          continue;
         }
+
+        const SDL_Rect& chunk_bounds = chunks[chunk].image->default_bounds();
+        SDL_Rect render_bounds = {(j * chunk_px) - camera.x,
+                                  (i * chunk_px) - camera.y,
+                                  chunk_bounds.w, chunk_bounds.h};
+
+        //one copy per chunk
+        chunks[chunk].image->render_copy(renderer,chunk_bounds,render_bounds);
       }
     }
   }
@@ -300,7 +377,7 @@ namespace tilemap {
    * @return layer width
    */
   int layer_t::get_layer_width() const {
-    return contents.at(0).size() * tile_dim;
+    return width * tile_dim;
   }
 
   /**
@@ -308,7 +385,7 @@ namespace tilemap {
    * @return layer height
    */
   int layer_t::get_layer_height() const {
-    return contents.size() * tile_dim;
+    return height * tile_dim;
   }
 
 }}
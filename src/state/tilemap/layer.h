@@ -11,16 +11,19 @@
 #include <SDL2/SDL_image.h>
 #include <vector>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
+#include <memory>
 #include "../../common/component.h"
 #include "../../common/image.h"
 #include "../../common/shared_resources.h"
+#include "map_document.h"
 
 namespace state {
 namespace tilemap {
 
+  //width and height of a pre-rendered layer chunk (in tiles)
+  #define LAYER_CHUNK_TILES 16
+
   /*
    * Tilemap layer
    */
@@ -32,17 +35,67 @@ namespace tilemap {
     std::shared_ptr<common::image_t> tileset;
     //layer index
     size_t idx;
-    //the contents of the layer
-    std::vector<std::vector<int>> contents;
+    //the parsed map file (shared with other layers)
+    std::shared_ptr<map_document_t> map;
+    //view of this layer's tiles within the map (row major)
+    int16_t* tiles;
+    //layer dimensions (in tiles)
+    int width;
+    int height;
     //tile dimension
     int tile_dim;
 
+    //a pre-rendered square of tiles
+    struct chunk_t {
+      std::unique_ptr<common::image_t> image;
+      //whether the tiles changed since the chunk was rendered
+      bool dirty = true;
+    };
+
+    //chunks (row major), rendered lazily when dirty
+    mutable std::vector<chunk_t> chunks;
+    int chunks_wide;
+    int chunks_high;
+    //whether the layer is drawn from chunks (needs render target support)
+    bool chunked;
+
+    //solid layers only: one bit per tile, rows padded to whole words
+    std::vector<uint64_t> solid_mask;
+    int mask_row_words;
+
+    /**
+     * Build the solidity bitmask (one bit per tile)
+     */
+    void build_solid_mask();
+
+    /**
+     * Render a range of tiles
+     * @param renderer  the sdl renderer
+     * @param origin_x  the position (px) that maps to 0 on the render target
+     * @param origin_y  the position (px) that maps to 0 on the render target
+     * @param row_start the first row
+     * @param row_end   the row to stop at
+     * @param col_start the first column
+     * @param col_end   the column to stop at
+     */
+    void render_tiles(SDL_Renderer& renderer,
+                      int origin_x, int origin_y,
+                      int row_start, int row_end,
+                      int col_start, int col_end) const;
+
     /**
-     * Parse map contents into buffer
-     * @param file the file
-     * @param max_height the maximum height that should be read
+     * Split the layer into chunks (each is rendered when first drawn)
+     * @param renderer the sdl renderer
      */
-    void parse_map_lines(std::ifstream& file, int max_height);
+    void build_chunks(SDL_Renderer& renderer);
+
+    /**
+     * Render the tiles in a chunk to the chunk texture
+     * @param  renderer the sdl renderer
+     * @param  chunk    the index of the chunk
+     * @return          whether the chunk could be rendered
+     */
+    bool bake_chunk(SDL_Renderer& renderer, size_t chunk) const;
 
     /**
      * Check if a position is within the bounds of the layer
@@ -50,7 +103,22 @@ namespace tilemap {
      * @param  y position y
      * @return   whether this point is in bounds
      */
-    bool in_bounds(int x, int y) const;
+    bool in_bounds(int x, int y) const {
+      int idx_x = x / tile_dim;
+      int idx_y = y / tile_dim;
+      return ((unsigned)idx_x < (unsigned)width) &&
+             ((unsigned)idx_y < (unsigned)height);
+    }
+
+    /**
+     * Get a tile (unchecked)
+     * @param  idx_x tile column
+     * @param  idx_y tile row
+     * @return       the tile index (-1 for none)
+     */
+    int16_t tile_at(int idx_x, int idx_y) const {
+      return tiles[(idx_y * width) + idx_x];
+    }
 
     /**
      * Determine whether a solid map layer collides with a component
@@ -59,6 +127,14 @@ namespace tilemap {
      */
     bool collides_with(const common::component_t& other) const override;
 
+    /**
+     * Collect the solid tiles of this layer within an area
+     * @param area   the area to collect from
+     * @param solids the tile rects (appended)
+     */
+    void solid_rects(const SDL_Rect& area,
+                     std::vector<SDL_Rect>& solids) const override;
+
     /**
      * Check to see if the map is solid at this position
      * @param  x position x
@@ -81,9 +157,14 @@ namespace tilemap {
      * Render the current state
      */
     void render(SDL_Renderer& renderer,
-                const SDL_Rect& camera) const override;
+                const SDL_Rect& camera,
+                float alpha) const override;
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_LAYER;
+    typedef layer_t component_kind_owner_t;
+
     /**
      * Constructor
      * @param path the path to the layer file
@@ -109,6 +190,14 @@ namespace tilemap {
      * @return layer height
      */
     int get_layer_height() const;
+
+    /**
+     * Change a tile (the chunk containing it is re-rendered when next drawn)
+     * @param x    tile column
+     * @param y    tile row
+     * @param tile the new tile index (-1 for none)
+     */
+    void set_tile(int x, int y, int tile);
   };
 
 }}
@@ -0,0 +1,444 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "map_document.h"
+#include "../../common/launch_exception.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace state {
+namespace tilemap {
+
+  #define COMMA ','
+  #define SPACE ' '
+  #define LAYER "layer"
+  #define TILE_WIDTH "tilewidth"
+  #define TILES_HIGH "tileshigh"
+
+  /**
+   * Parse a labeled number
+   * @param  line the line ('label value')
+   * @return      the parsed number (or throws)
+   */
+  static int parse_labeled_number(const std::string& line) {
+    //parse tile dimension
+    std::stringstream s_stream(line);
+
+    bool first = true;
+
+    //get each value
+    while (s_stream.good()) {
+      std::string substr;
+      std::getline(s_stream, substr, SPACE);
+
+      if (!first) {
+        try {
+          return std::stoi(substr);
+        } catch (...) {
+          throw common::launch_exception("failed to parse number from line in map file: " + line);
+        }
+      }
+      first = false;
+    }
+    throw common::launch_exception("failed to parse number from line in map file: " + line);
+    return 0;
+  }
+
+  /**
+   * Check if a string starts with some prefix
+   * @param  str    the string
+   * @param  prefix the prefix
+   * @return        whether str starts with prefix
+   */
+  static bool startswith(const std::string& str, const std::string& prefix) {
+    return str.rfind(prefix, 0) == 0;
+  }
+
+  //sizes of the binary header and layer table entries
+  #define MAP_HEADER_SIZE 12
+  #define MAP_TABLE_ENTRY_SIZE 12
+
+  /**
+   * Read a little endian u16
+   * @param  data the bytes
+   * @return      the value
+   */
+  static uint16_t read_u16(const uint8_t* data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+  }
+
+  /**
+   * Read a little endian u32
+   * @param  data the bytes
+   * @return      the value
+   */
+  static uint32_t read_u32(const uint8_t* data) {
+    return (uint32_t)read_u16(data) | ((uint32_t)read_u16(data + 2) << 16);
+  }
+
+  /**
+   * Write a little endian u16
+   * @param file  the file
+   * @param value the value
+   */
+  static void write_u16(std::ofstream& file, uint16_t value) {
+    file.put((char)(value & 0xFF));
+    file.put((char)(value >> 8));
+  }
+
+  /**
+   * Write a little endian u32
+   * @param file  the file
+   * @param value the value
+   */
+  static void write_u32(std::ofstream& file, uint32_t value) {
+    write_u16(file, (uint16_t)(value & 0xFFFF));
+    write_u16(file, (uint16_t)(value >> 16));
+  }
+
+  /**
+   * Check if a string ends with some suffix
+   * @param  str    the string
+   * @param  suffix the suffix
+   * @return        whether str ends with suffix
+   */
+  static bool endswith(const std::string& str, const std::string& suffix) {
+    return (str.size() >= suffix.size()) &&
+           (str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0);
+  }
+
+  /**
+   * Constructor, loads the file (or throws)
+   * Files ending in MAP_BINARY_EXT are loaded as binary, otherwise as text
+   * @param path the path to the map file
+   */
+  map_document_t::map_document_t(const std::string& path)
+    : path(path),
+      tile_dim(8),
+      layers(),
+      mapped(NULL),
+      mapped_size(0) {
+    if (endswith(path,MAP_BINARY_EXT)) {
+      load_binary();
+    } else {
+      load_text();
+    }
+
+    if (layers.empty()) {
+      throw common::launch_exception("failed to read from map file: " +
+        path + " (nothing loaded)");
+    }
+    //layers divide by the tile size
+    if (tile_dim <= 0) {
+      throw common::launch_exception("invalid tile size in map file: " + path);
+    }
+  }
+
+  //unmap the binary file
+  map_document_t::~map_document_t() {
+    unmap();
+  }
+
+  /**
+   * Unmap the binary file (if mapped)
+   */
+  void map_document_t::unmap() {
+    if (mapped != NULL) {
+      munmap(mapped, mapped_size);
+      mapped = NULL;
+      mapped_size = 0;
+    }
+  }
+
+  /**
+   * Parse a text map file
+   */
+  void map_document_t::load_text() {
+    int max_height = 0; //the height to parse for any given layer
+    int layer = -1; //the layer being parsed (for errors)
+    std::string line; //the line read from the file
+
+    try {
+      std::ifstream map_file(path);
+
+      while (std::getline(map_file, line)) {
+        if (!line.empty()) {
+          if (startswith(line,TILES_HIGH)) {
+            max_height = parse_labeled_number(line);
+
+          } else if (startswith(line,TILE_WIDTH)) {
+            this->tile_dim = parse_labeled_number(line);
+
+          } else if (startswith(line,LAYER)) {
+            //parse the layer that follows
+            layer = parse_labeled_number(line);
+            parse_map_lines(map_file,max_height,layers[layer]);
+            layer = -1;
+          }
+        }
+      }
+
+    } catch (const common::launch_exception& e) {
+      //errors from parse_map_lines name the file and the reason, add the layer
+      if (layer >= 0) {
+        throw common::launch_exception(e.trace() + ", layer " + std::to_string(layer));
+      }
+      throw common::launch_exception("failed to read from map file: " + path);
+
+    } catch (...) {
+      throw common::launch_exception("failed to read from map file: " + path +
+        (layer >= 0 ? ", layer " + std::to_string(layer) : ""));
+    }
+  }
+
+  /**
+   * Load a binary map file (memory mapped, tiles used in place)
+   */
+  void map_document_t::load_binary() {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw common::launch_exception("failed to open map file: " + path);
+    }
+
+    struct stat file_stat;
+    if ((fstat(fd, &file_stat) != 0) || (file_stat.st_size < MAP_HEADER_SIZE)) {
+      close(fd);
+      throw common::launch_exception("invalid binary map file: " + path);
+    }
+    size_t size = (size_t)file_stat.st_size;
+
+    //private mapping: tile edits are copy on write and never reach the file
+    mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      mapped = NULL;
+      throw common::launch_exception("failed to map file: " + path);
+    }
+    mapped_size = size;
+    uint8_t* data = (uint8_t*)mapped;
+
+    //check the header
+    bool valid = (std::memcmp(data, MAP_BINARY_MAGIC, 4) == 0) &&
+                 (read_u16(data + 4) == MAP_BINARY_VERSION);
+    size_t layer_count = valid ? read_u16(data + 6) : 0;
+    tile_dim = read_u16(data + 8);
+    //a zero tile size would divide by zero when laying out the layers
+    valid = valid && (layer_count > 0) && (tile_dim > 0) &&
+            ((MAP_HEADER_SIZE + (layer_count * MAP_TABLE_ENTRY_SIZE)) <= size);
+
+    for (size_t i=0; valid && (i<layer_count); i++) {
+      const uint8_t* entry = data + MAP_HEADER_SIZE + (i * MAP_TABLE_ENTRY_SIZE);
+      int layer_idx = (int16_t)read_u16(entry);
+      size_t width = read_u16(entry + 2);
+      size_t height = read_u16(entry + 4);
+      size_t offset = read_u32(entry + 8);
+
+      valid = (offset + (width * height * sizeof(int16_t))) <= size;
+      if (!valid) {
+        break;
+      }
+
+      layer_tiles_t& tiles = layers[layer_idx];
+      tiles.width = (int)width;
+      tiles.height = (int)height;
+      uint8_t* tile_data = data + offset;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+      //the file layout is the in memory layout, point straight at it
+      if ((offset % alignof(int16_t)) == 0) {
+        tiles.tiles = (int16_t*)tile_data;
+        continue;
+      }
+#endif
+
+      //big endian host or misaligned layer, copy
+      tiles.storage.resize(width * height);
+      for (size_t t=0; t<tiles.storage.size(); t++) {
+        tiles.storage[t] = (int16_t)read_u16(tile_data + (t * sizeof(int16_t)));
+      }
+      tiles.tiles = tiles.storage.data();
+    }
+
+    if (!valid) {
+      //the constructor throws, so the destructor won't unmap
+      layers.clear();
+      unmap();
+      throw common::launch_exception("invalid binary map file: " + path);
+    }
+  }
+
+  /**
+   * Write the map in the binary format
+   * @param out_path the file to write
+   */
+  void map_document_t::save_binary(const std::string& out_path) const {
+    std::ofstream file(out_path, std::ios::binary | std::ios::trunc);
+    if (!file.good()) {
+      throw common::launch_exception("failed to open map file for writing: " + out_path);
+    }
+
+    //order layers by index
+    std::vector<int> indices;
+    for (const auto& layer : layers) {
+      indices.push_back(layer.first);
+    }
+    std::sort(indices.begin(), indices.end());
+
+    //header
+    file.write(MAP_BINARY_MAGIC, 4);
+    write_u16(file, MAP_BINARY_VERSION);
+    write_u16(file, (uint16_t)indices.size());
+    write_u16(file, (uint16_t)tile_dim);
+    write_u16(file, 0);
+
+    //layer table
+    uint32_t offset = MAP_HEADER_SIZE + (indices.size() * MAP_TABLE_ENTRY_SIZE);
+    for (int layer_idx : indices) {
+      const layer_tiles_t& tiles = layers.at(layer_idx);
+
+      write_u16(file, (uint16_t)(int16_t)layer_idx);
+      write_u16(file, (uint16_t)tiles.width);
+      write_u16(file, (uint16_t)tiles.height);
+      write_u16(file, 0);
+      write_u32(file, offset);
+      offset += tiles.width * tiles.height * sizeof(int16_t);
+    }
+
+    //tiles
+    for (int layer_idx : indices) {
+      const layer_tiles_t& tiles = layers.at(layer_idx);
+      for (int t=0; t<(tiles.width * tiles.height); t++) {
+        write_u16(file, (uint16_t)tiles.tiles[t]);
+      }
+    }
+
+    if (!file.good()) {
+      throw common::launch_exception("failed to write map file: " + out_path);
+    }
+  }
+
+  /**
+   * Parse map contents into a layer
+   * @param file       the file
+   * @param max_height the maximum height that should be read
+   * @param tiles      the layer to parse into
+   */
+  void map_document_t::parse_map_lines(std::ifstream& file, int max_height, layer_tiles_t& tiles) {
+    std::string line;
+    //rows as parsed (may differ in length)
+    std::vector<std::vector<int16_t>> rows;
+
+    while (std::getline(file, line)) {
+      //check if the section end reached
+      if (line.empty()) {
+        break;
+      }
+
+      if ((int)rows.size() >= max_height) {
+        break;
+      }
+
+      //split line by commas
+      rows.emplace_back();
+      std::stringstream s_stream(line);
+
+      //get each value
+      while (s_stream.good()) {
+         std::string substr;
+         std::getline(s_stream, substr, COMMA);
+
+         if (!substr.empty()) {
+           //attempt to parse value
+           int type = 0;
+           try {
+             type = std::stoi(substr);
+           } catch (...) {
+             throw common::launch_exception("failed to read from map file: " + path);
+           }
+
+           //tiles are stored as int16 (any negative value is no tile)
+           if (type > INT16_MAX) {
+             throw common::launch_exception("tile index out of range in map file: " + path);
+           }
+           rows.back().push_back((int16_t)(type < 0 ? -1 : type));
+         }
+      }
+    }
+
+    //flatten (short rows padded with empty tiles)
+    tiles.height = (int)rows.size();
+    tiles.width = 0;
+    for (const std::vector<int16_t>& row : rows) {
+      tiles.width = std::max(tiles.width, (int)row.size());
+    }
+    tiles.storage.assign(tiles.width * tiles.height, -1);
+    for (int y=0; y<tiles.height; y++) {
+      std::copy(rows[y].begin(), rows[y].end(), tiles.storage.begin() + (y * tiles.width));
+    }
+    tiles.tiles = tiles.storage.data();
+  }
+
+  /**
+   * Get a parsed map (parsing it the first time it is requested)
+   * A text map uses its binary version instead if one exists, is up to date
+   * and loads (a stale or damaged binary falls back to the text)
+   * @param  path      the path to the map file
+   * @param  resources the shared resources (holds the cache)
+   * @return           the parsed map
+   */
+  std::shared_ptr<map_document_t> map_document_t::get(const std::string& path,
+                                                      common::shared_resources& resources) {
+    std::shared_ptr<map_document_t>& doc = resources.map_documents[path];
+    if (doc) {
+      return doc;
+    }
+
+    //prefer the binary version of a text map if it is up to date
+    if (!endswith(path,MAP_BINARY_EXT)) {
+      std::string binary_path = path.substr(0, path.rfind('.')) + MAP_BINARY_EXT;
+      struct stat text_stat;
+      struct stat binary_stat;
+      if ((stat(binary_path.c_str(), &binary_stat) == 0) &&
+          ((stat(path.c_str(), &text_stat) != 0) ||
+           (binary_stat.st_mtime >= text_stat.st_mtime))) {
+        try {
+          doc = std::make_shared<map_document_t>(binary_path);
+        } catch (const common::launch_exception&) {
+          //old version or damaged, the text map is still supported
+          doc.reset();
+        }
+      }
+    }
+
+    if (!doc) {
+      doc = std::make_shared<map_document_t>(path);
+    }
+    return doc;
+  }
+
+  /**
+   * Get the tiles for a layer (throws if not in the file)
+   * Layers are shared views: edits are seen by every layer_t using them
+   * @param  idx the layer index
+   * @return     the layer tiles
+   */
+  layer_tiles_t& map_document_t::get_layer(int idx) {
+    auto layer = layers.find(idx);
+    if ((layer == layers.end()) || (layer->second.tiles == nullptr) ||
+        (layer->second.width * layer->second.height == 0)) {
+      throw common::launch_exception("failed to read from map file: " +
+        path + ", layer " + std::to_string(idx) + " (nothing loaded)");
+    }
+    return layer->second;
+  }
+
+}}
@@ -0,0 +1,130 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_STATE_TILEMAP_MAP_DOCUMENT_H
+#define _DIVEBAR_STATE_TILEMAP_MAP_DOCUMENT_H
+
+#include <vector>
+#include <stdint.h>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include "../../common/shared_resources.h"
+
+namespace state {
+namespace tilemap {
+
+  /*
+   * The tiles in a single layer (row major tile indices, -1 for none)
+   */
+  struct layer_tiles_t {
+    //dimensions (in tiles)
+    int width = 0;
+    int height = 0;
+    //width * height tiles (in the mapped binary file, or in storage)
+    int16_t* tiles = nullptr;
+    //tiles parsed from text (or copied from a binary file that can't be used in place)
+    std::vector<int16_t> storage;
+  };
+
+  //binary map files (see map_document_t::save_binary)
+  #define MAP_BINARY_EXT ".dbm"
+  #define MAP_BINARY_MAGIC "DBMP"
+  #define MAP_BINARY_VERSION 1
+
+  /*
+   * A map file parsed once into all of its layers
+   * (shared by every layer_t that points at the same file)
+   */
+  class map_document_t {
+  private:
+    //the map file path
+    std::string path;
+    //tile dimension
+    int tile_dim;
+    //layers by index
+    std::unordered_map<int, layer_tiles_t> layers;
+    //the mapped binary file the layers point into (NULL for text maps)
+    void* mapped;
+    size_t mapped_size;
+
+    /**
+     * Parse map contents into a layer
+     * @param file       the file
+     * @param max_height the maximum height that should be read
+     * @param tiles      the layer to parse into
+     */
+    void parse_map_lines(std::ifstream& file, int max_height, layer_tiles_t& tiles);
+
+    /**
+     * Parse a text map file
+     */
+    void load_text();
+
+    /**
+     * Load a binary map file (memory mapped, tiles used in place)
+     */
+    void load_binary();
+
+    /**
+     * Unmap the binary file (if mapped)
+     */
+    void unmap();
+
+  public:
+    /**
+     * Constructor, loads the file (or throws)
+     * Files ending in MAP_BINARY_EXT are loaded as binary, otherwise as text
+     * @param path the path to the map file
+     */
+    map_document_t(const std::string& path);
+    map_document_t(const map_document_t&) = delete;
+    map_document_t& operator=(const map_document_t&) = delete;
+
+    //unmap the binary file
+    ~map_document_t();
+
+    /**
+     * Get a parsed map (parsing it the first time it is requested)
+     * A text map uses its binary version instead if one exists, is up to date
+     * and loads (a stale or damaged binary falls back to the text)
+     * @param  path      the path to the map file
+     * @param  resources the shared resources (holds the cache)
+     * @return           the parsed map
+     */
+    static std::shared_ptr<map_document_t> get(const std::string& path,
+                                               common::shared_resources& resources);
+
+    /**
+     * Get the tile dimension
+     * @return tile width and height (px)
+     */
+    int get_tile_dim() const { return tile_dim; }
+
+    /**
+     * Get the tiles for a layer (throws if not in the file)
+     * Layers are shared views: edits are seen by every layer_t using them
+     * @param  idx the layer index
+     * @return     the layer tiles
+     */
+    layer_tiles_t& get_layer(int idx);
+
+    /**
+     * Write the map in the binary format
+     *
+     * Layout (little endian):
+     *   header   char[4] magic, u16 version, u16 layer count, u16 tile dim, u16 reserved
+     *   table    per layer: i16 index, u16 width, u16 height, u16 reserved, u32 offset
+     *   tiles    per layer: i16[width * height] row major, at offset from file start
+     * @param out_path the file to write
+     */
+    void save_binary(const std::string& out_path) const;
+  };
+
+}}
+
+#endif /*_DIVEBAR_STATE_TILEMAP_MAP_DOCUMENT_H*/
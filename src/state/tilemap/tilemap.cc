@@ -27,7 +27,9 @@ namespace tilemap {
       map_path(map_path),
       tileset(tileset),
       layers(layers),
-      solid_idx(solid_idx) {}
+      solid_idx(solid_idx) {
+    add_kind(COMPONENT_KIND_TILEMAP);
+  }
 
     /**
      * Load any resources for this component
@@ -63,6 +65,18 @@ namespace tilemap {
     return false;
   }
 
+  /**
+   * Collect the solid tiles of this map within an area
+   * @param area   the area to collect from
+   * @param solids the tile rects (appended)
+   */
+  void tilemap_t::solid_rects(const SDL_Rect& area,
+                              std::vector<SDL_Rect>& solids) const {
+    if (solid_idx > -1) {
+      this->get_nth_child<common::component_t>(solid_idx).solid_rects(area,solids);
+    }
+  }
+
   /**
    * Check to see if the map is solid at this position
    * @param  x position x
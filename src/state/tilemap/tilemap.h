@@ -39,6 +39,14 @@ namespace tilemap {
      */
     bool collides_with(const common::component_t& other) const override;
 
+    /**
+     * Collect the solid tiles of this map within an area
+     * @param area   the area to collect from
+     * @param solids the tile rects (appended)
+     */
+    void solid_rects(const SDL_Rect& area,
+                     std::vector<SDL_Rect>& solids) const override;
+
     /**
      * Check to see if the map is solid at this position
      * @param  x position x
@@ -58,6 +66,10 @@ namespace tilemap {
               common::shared_resources& resources) override;
 
   public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_TILEMAP;
+    typedef tilemap_t component_kind_owner_t;
+
     /**
      * Constructor
      * @param map_path   path to tilemap resource
@@ -0,0 +1,67 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include "headless.h"
+#include "window.h"
+#include "../common/launch_exception.h"
+
+namespace window {
+
+  /**
+   * Constructor
+   */
+  headless_t::headless_t() {
+
+    //init sdl events only (no video device)
+    if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+      throw common::launch_exception("failed to init sdl events: " + std::string(SDL_GetError()));
+    }
+
+    //create a surface to render into
+    this->surface = SDL_CreateRGBSurface(0,LOGICAL_W_PX,LOGICAL_H_PX,32,0,0,0,0);
+
+    if (this->surface == NULL) {
+      throw common::launch_exception("failed to create headless surface: " + std::string(SDL_GetError()));
+    }
+
+    //software renderer keeps textures cpu side
+    this->renderer = SDL_CreateSoftwareRenderer(this->surface);
+
+    if (this->renderer == NULL) {
+      throw common::launch_exception("failed to init headless renderer: " + std::string(SDL_GetError()));
+    }
+
+    int img_init_flags = IMG_INIT_PNG;
+
+    //setup png initialization
+    if (!(IMG_Init(img_init_flags) & img_init_flags)) {
+      throw common::launch_exception("failed to init png load: " + std::string(IMG_GetError()));
+    }
+  }
+
+  /**
+   * Destructor
+   */
+  headless_t::~headless_t() {
+    //free resources
+    SDL_DestroyRenderer(this->renderer);
+    SDL_FreeSurface(this->surface);
+    renderer = NULL;
+    surface = NULL;
+
+    //quit subsystems
+    IMG_Quit();
+    SDL_Quit();
+  }
+
+  /**
+   * Get the (software) renderer
+   * @return the renderer
+   */
+  SDL_Renderer& headless_t::get_renderer() {
+    return *renderer;
+  }
+}
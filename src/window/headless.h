@@ -0,0 +1,44 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#ifndef _DIVEBAR_WINDOW_HEADLESS_H
+#define _DIVEBAR_WINDOW_HEADLESS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+namespace window {
+
+  /*
+   * Offscreen render target with no window
+   * (software renderer drawing into a surface, no display needed)
+   */
+  class headless_t {
+  private:
+    SDL_Surface *surface;
+    SDL_Renderer *renderer;
+
+  public:
+    /**
+     * Constructor
+     */
+    headless_t();
+    headless_t(const headless_t&) = delete;
+    headless_t& operator=(const headless_t&) = delete;
+
+    //free sdl resources
+    ~headless_t();
+
+    /**
+     * Get the (software) renderer
+     * @return the renderer
+     */
+    SDL_Renderer& get_renderer();
+  };
+
+}
+
+#endif /*_DIVEBAR_WINDOW_HEADLESS_H*/
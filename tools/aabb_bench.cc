@@ -0,0 +1,122 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include <stdlib.h>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../src/common/aabb_batch.h"
+
+//defaults
+#define BENCH_WORLD_PX 8192
+#define BENCH_MIN_WORK 20000000
+
+namespace {
+
+  /**
+   * Time one kernel against a set of rects
+   * @param  kernel   the kernel
+   * @param  camera   the query rect
+   * @param  rects    the rects
+   * @param  expected the scalar hit mask (the kernel must match it)
+   * @param  hits     the number of hits (set)
+   * @return          ns per rect tested, or < 0 if the mask didn't match
+   */
+  double time_kernel(common::aabb_kernel_t kernel,
+                     const SDL_Rect& camera,
+                     const std::vector<SDL_Rect>& rects,
+                     const std::vector<uint64_t>& expected,
+                     size_t& hits) {
+    std::vector<uint64_t> mask;
+    //repeat small sets so that every run tests a similar number of rects
+    size_t reps = std::max((size_t)BENCH_MIN_WORK / rects.size(), (size_t)1);
+
+    hits = common::aabb_overlap_mask(kernel, camera, rects.data(), rects.size(), mask);
+    if (mask != expected) {
+      return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for (size_t i=0; i<reps; i++) {
+      total += common::aabb_overlap_mask(kernel, camera, rects.data(), rects.size(), mask);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    //keep the result live
+    if (total != hits * reps) {
+      std::cerr << "kernel mismatch" << std::endl;
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / ((double)reps * rects.size());
+  }
+
+}
+
+/**
+ * Time the batch overlap kernels against a camera sized query
+ * usage: aabbbench.out [counts...]
+ */
+int main(int argc, char **argv) {
+  std::vector<size_t> counts = {1000, 10000, 100000};
+  if (argc > 1) {
+    counts.clear();
+    for (int i=1; i<argc; i++) {
+      int count = atoi(argv[i]);
+      if (count <= 0) {
+        std::cerr << "usage: " << argv[0] << " [counts...]" << std::endl;
+        return EXIT_FAILURE;
+      }
+      counts.push_back(count);
+    }
+  }
+
+  //entity sized rects scattered over a large level
+  std::mt19937 rng(2021);
+  std::uniform_int_distribution<int> position(0, BENCH_WORLD_PX);
+  std::uniform_int_distribution<int> size(4, 32);
+  SDL_Rect camera = {BENCH_WORLD_PX / 2, BENCH_WORLD_PX / 2, 256, 144};
+
+  const common::aabb_kernel_t kernels[] = {common::AABB_KERNEL_SCALAR,
+                                           common::AABB_KERNEL_SSE2,
+                                           common::AABB_KERNEL_AVX2};
+
+  for (size_t count : counts) {
+    std::vector<SDL_Rect> rects(count);
+    for (SDL_Rect& r : rects) {
+      r = {position(rng), position(rng), size(rng), size(rng)};
+    }
+
+    //every kernel must hit exactly what the scalar one hits
+    std::vector<uint64_t> expected;
+    common::aabb_overlap_mask(common::AABB_KERNEL_SCALAR, camera, rects.data(), rects.size(), expected);
+
+    double scalar_ns = 0;
+    for (common::aabb_kernel_t kernel : kernels) {
+      if (!common::aabb_kernel_available(kernel)) {
+        continue;
+      }
+      size_t hits = 0;
+      double ns = time_kernel(kernel, camera, rects, expected, hits);
+      if (ns < 0) {
+        std::cerr << count << " rects, " << common::aabb_kernel_name(kernel)
+                  << ": hit mask differs from scalar" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (kernel == common::AABB_KERNEL_SCALAR) {
+        scalar_ns = ns;
+      }
+
+      std::cout << count << " rects, " << common::aabb_kernel_name(kernel) << ": "
+                << ns << "ns/rect, " << hits << " hits, "
+                << (scalar_ns / ns) << "x scalar" << std::endl;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,33 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+#include "../src/state/tilemap/map_document.h"
+#include "../src/common/launch_exception.h"
+
+/**
+ * Convert a text map file to the binary map format
+ * usage: mapconv.out input.txt output.dbm
+ */
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " input.txt output" << MAP_BINARY_EXT << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    //parse the text map and write it back out
+    state::tilemap::map_document_t doc(argv[1]);
+    doc.save_binary(argv[2]);
+  } catch (const common::launch_exception& e) {
+    std::cerr << e.trace() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/*
+ * Dive Bar
+ * (C) Jack Hay, 2021
+ * All rights reserved
+ */
+
+#include <stdlib.h>
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "../src/common/component.h"
+#include "../src/state/entity/player.h"
+
+//defaults
+#define BENCH_ENTITIES 2000
+#define BENCH_TICKS 1000
+#define BENCH_ANIMS_PER_ENTITY 3
+//type lookup passes per tick
+#define BENCH_LOOKUP_PASSES 4
+
+namespace {
+
+  /*
+   * Stand in for an animation (a leaf updated every tick)
+   */
+  class bench_leaf_t : public common::component_t {
+  private:
+    int counter;
+
+    void update(common::component_t& parent) override { counter++; }
+
+    void load(SDL_Renderer& renderer,
+              const common::component_t& parent,
+              common::shared_resources& resources) override {}
+
+  public:
+    //kind tag checked by get_nth_child/get_as
+    static const uint16_t component_kind = COMPONENT_KIND_ANIM;
+    typedef bench_leaf_t component_kind_owner_t;
+
+    bench_leaf_t() : common::component_t({0,0,8,8}, COMPONENT_VISIBLE), counter(0) {
+      add_kind(COMPONENT_KIND_ANIM);
+    }
+  };
+
+  /*
+   * Stand in for an entity (walks back and forth, has animation children)
+   */
+  class bench_entity_t : public common::component_t {
+  private:
+    int dx;
+    std::vector<common::child_handle_t<bench_leaf_t>> anims;
+
+    void update(common::component_t& parent) override {
+      const SDL_Rect& bounds = get_bounds();
+      if ((bounds.x % 64) == 0) {
+        dx = -dx;
+      }
+      set_position(bounds.x + dx, bounds.y);
+
+      for (common::child_handle_t<bench_leaf_t> anim : anims) {
+        update_child(anim.idx);
+      }
+    }
+
+    void load(SDL_Renderer& renderer,
+              const common::component_t& parent,
+              common::shared_resources& resources) override {}
+
+  public:
+    bench_entity_t(int x, int y)
+      : common::component_t({x,y,8,16}, COMPONENT_VISIBLE |
+                                        COMPONENT_COLLIDABLE |
+                                        COMPONENT_GRAVITY),
+        dx(1),
+        anims() {
+      add_kind(COMPONENT_KIND_ENTITY);
+      for (int i=0; i<BENCH_ANIMS_PER_ENTITY; i++) {
+        anims.push_back(add_child_as(std::make_unique<bench_leaf_t>()));
+      }
+    }
+
+    /**
+     * Look up the animation children through kind tags
+     * @return the number found
+     */
+    int lookup_tagged() {
+      int found = 0;
+      for (common::child_handle_t<bench_leaf_t> anim : anims) {
+        found += (get_nth_child<bench_leaf_t>(anim.idx).get_bounds().w > 0);
+      }
+      return found;
+    }
+
+    /**
+     * Look up the animation children through rtti (the old path)
+     * @return the number found
+     */
+    int lookup_rtti() {
+      int found = 0;
+      for (common::child_handle_t<bench_leaf_t> anim : anims) {
+        found += (dynamic_cast<bench_leaf_t*>(&get_nth_child(anim.idx)) != nullptr);
+      }
+      return found;
+    }
+  };
+
+  /*
+   * Solid floor under a row of entities
+   */
+  class bench_floor_t : public common::component_t {
+  private:
+    void load(SDL_Renderer& renderer,
+              const common::component_t& parent,
+              common::shared_resources& resources) override {}
+
+  public:
+    explicit bench_floor_t(int y)
+      : common::component_t({0,y,64 * 64,8}, COMPONENT_SOLID | COMPONENT_COLLIDABLE) {}
+  };
+
+  /*
+   * Stand in for a level (entities standing on a solid floor)
+   */
+  class bench_level_t : public common::component_t {
+  private:
+    //the entity children
+    std::vector<common::child_handle_t<bench_entity_t>> entities;
+
+    void load(SDL_Renderer& renderer,
+              const common::component_t& parent,
+              common::shared_resources& resources) override {}
+
+  public:
+    explicit bench_level_t(int entities)
+      : common::component_t({0,0,0,0}, COMPONENT_ALWAYS_VISIBLE),
+        entities() {
+      enable_broadphase(32);
+
+      //spread the entities over rows with a floor under each row
+      const int per_row = 64;
+      for (int i=0; i<entities; i++) {
+        int row = i / per_row;
+        this->entities.push_back(add_child_as(std::make_unique<bench_entity_t>((i % per_row) * 64 + 1, row * 64)));
+      }
+      for (int row=0; row<=(entities / per_row); row++) {
+        add_child(std::make_unique<bench_floor_t>(row * 64 + 16));
+      }
+    }
+
+    /**
+     * Run one tick
+     */
+    void tick() { update(*this); }
+
+    /**
+     * Find players and animations as the update and event paths do, with kind tags
+     * @return the number of hits (keeps the work observable)
+     */
+    int lookup_tagged() {
+      int found = 0;
+      for (common::child_handle_t<bench_entity_t> entity : entities) {
+        found += get_nth_child(entity.idx).has_kind(COMPONENT_KIND_PLAYER);
+        found += get_child(entity).lookup_tagged();
+      }
+      return found;
+    }
+
+    /**
+     * Find players and animations with dynamic_cast (before kind tags)
+     * @return the number of hits (keeps the work observable)
+     */
+    int lookup_rtti() {
+      int found = 0;
+      for (common::child_handle_t<bench_entity_t> entity : entities) {
+        found += (dynamic_cast<state::entity::player_t*>(&get_nth_child(entity.idx)) != nullptr);
+        found += get_child(entity).lookup_rtti();
+      }
+      return found;
+    }
+  };
+
+}
+
+/**
+ * Time the component update loop on a synthetic level
+ * usage: updatebench.out [entities] [ticks]
+ */
+int main(int argc, char **argv) {
+  int entities = (argc > 1) ? atoi(argv[1]) : BENCH_ENTITIES;
+  int ticks = (argc > 2) ? atoi(argv[2]) : BENCH_TICKS;
+  if ((entities <= 0) || (ticks <= 0)) {
+    std::cerr << "usage: " << argv[0] << " [entities] [ticks]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bench_level_t level(entities);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<ticks; i++) {
+    level.tick();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double ms = std::chrono::duration<double, std::milli>(end - start).count();
+  double updates = (double)ticks * entities * (BENCH_ANIMS_PER_ENTITY + 1);
+
+  std::cout << entities << " entities, " << ticks << " ticks: "
+            << ms << "ms (" << (ms / ticks) << "ms/tick, "
+            << ((ms * 1e6) / updates) << "ns/component update)" << std::endl;
+
+  //the same type lookups through kind tags and through rtti
+  double lookups = (double)ticks * BENCH_LOOKUP_PASSES * entities * (BENCH_ANIMS_PER_ENTITY + 1);
+  long found_tagged = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i=0; i<(ticks * BENCH_LOOKUP_PASSES); i++) {
+    found_tagged += level.lookup_tagged();
+  }
+  end = std::chrono::steady_clock::now();
+  double tagged_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+  long found_rtti = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i=0; i<(ticks * BENCH_LOOKUP_PASSES); i++) {
+    found_rtti += level.lookup_rtti();
+  }
+  end = std::chrono::steady_clock::now();
+  double rtti_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+  if (found_tagged != found_rtti) {
+    std::cerr << "lookup mismatch: " << found_tagged << " tagged, " << found_rtti << " rtti" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "type lookups: kind tags " << ((tagged_ms * 1e6) / lookups) << "ns, "
+            << "dynamic_cast " << ((rtti_ms * 1e6) / lookups) << "ns "
+            << "(" << (rtti_ms / tagged_ms) << "x)" << std::endl;
+  return EXIT_SUCCESS;
+}